@@ -47,6 +47,7 @@ namespace ALSA
 			m_areas.resize(channels);
 			m_offset = 0;
 			m_length = 0;
+			m_contiguous = false;
 
 			for (unsigned int i = 0; i < m_channels; i++) {
 				m_areas[i].addr = nullptr;
@@ -76,6 +77,7 @@ namespace ALSA
 		} else {
 			m_offset = 0;
 			m_length = size / m_unit;
+			m_contiguous = true;
 
 			for (unsigned int i = 0; i < m_channels; i++) {
 				m_areas[i].addr = buffer;
@@ -85,13 +87,25 @@ namespace ALSA
 
 	void Range::reset(const snd_pcm_channel_area_t* areas, snd_pcm_uframes_t length)
 	{
+		const unsigned int frame_bits = m_unit * CHAR_BIT;
+		const unsigned int sample_bits = frame_bits / m_channels;
+
 		m_offset = 0;
 		m_length = length;
+		m_contiguous = true;
 
 		for (unsigned int i = 0; i < m_channels; i++) {
 			m_areas[i].addr = areas[i].addr;
 			m_areas[i].first = areas[i].first;
 			m_areas[i].step = areas[i].step;
+
+			if (m_areas[i].addr != m_areas[0].addr) {
+				m_contiguous = false;
+			} else if (m_areas[i].first != sample_bits * i) {
+				m_contiguous = false;
+			} else if (m_areas[i].step != frame_bits) {
+				m_contiguous = false;
+			}
 		}
 	}
 
@@ -127,7 +141,13 @@ namespace ALSA
 			const snd_pcm_uframes_t source_available = source.m_length - source.m_offset;
 			const snd_pcm_uframes_t copied = std::min(maximum, std::min(target_available, source_available));
 
-			if (snd_pcm_areas_copy(target_areas, target_offset, source_areas, source_offset, channels, copied, format) < 0) {
+			if (source.m_contiguous && target.m_contiguous) {
+				const unsigned int unit = source.m_unit;
+				char* target_pointer = static_cast<char*>(target_areas[0].addr) + target_offset * unit;
+				const char* source_pointer = static_cast<const char*>(source_areas[0].addr) + source_offset * unit;
+				std::memcpy(target_pointer, source_pointer, copied * unit);
+				return copied;
+			} else if (snd_pcm_areas_copy(target_areas, target_offset, source_areas, source_offset, channels, copied, format) < 0) {
 				throw std::logic_error("invalid data feed into snd_pcm_areas_copy");
 			} else {
 				return copied;
@@ -25,7 +25,10 @@ namespace ALSA
 
 	/**
 	 * Range implements a mutable pointer to a section of audio buffer that can be
-	 * worked on.
+	 * worked on. The range remembers whether the underlying channel areas form
+	 * a single packed interleaved buffer, so that copies between two such
+	 * ranges can be done with a single bulk move instead of a frame-by-frame
+	 * walk over the areas.
 	 */
 	class Range
 	{
@@ -41,6 +44,14 @@ namespace ALSA
 			 */
 			bool valid() const noexcept;
 
+			/**
+			 * Check if the range covers a single packed interleaved buffer, aka
+			 * every channel area shares one buffer with samples packed back to
+			 * back without padding. The property is detected when the cursor is
+			 * reset and enables the bulk copy fast path.
+			 */
+			bool contiguous() const noexcept { return m_contiguous; }
+
 			/**
 			 * Reset the cursor to the given buffer. Throws exception if the given
 			 * buffer cannot match the audio buffer layout expected by the range.
@@ -62,6 +73,9 @@ namespace ALSA
 			/**
 			 * Copy data from the source range to the target range and return the
 			 * amount of frames copied. Both source and target are not beheaded.
+			 * When both ranges are contiguous, the whole run of frames is moved
+			 * with a single bulk copy; otherwise the ALSA area copy routine
+			 * walks the channel areas.
 			 */
 			static snd_pcm_uframes_t copy(Range& target, Range& source, snd_pcm_uframes_t maximum);
 
@@ -80,6 +94,7 @@ namespace ALSA
 			std::vector<snd_pcm_channel_area_t> m_areas;
 			snd_pcm_uframes_t m_offset;
 			snd_pcm_uframes_t m_length;
+			bool m_contiguous;
 
 	};
 
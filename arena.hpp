@@ -0,0 +1,164 @@
+
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "exception.hpp"
+
+
+#ifndef ARENA_HPP_
+#define ARENA_HPP_
+
+
+namespace Support
+{
+
+	/**
+	 * Arena implements a small bump allocator for per-stream staging buffers.
+	 *
+	 * An arena owns a single slab of backing storage. Allocations are served
+	 * by bumping an offset into the slab, and the whole arena is released at
+	 * once by resetting the offset, so a clear costs a single counter update
+	 * regardless of the number of allocations made.
+	 *
+	 * The backing storage is retained across clears and reserve only grows
+	 * it when the requested capacity exceeds the current one. A consumer
+	 * that reserves its demand at configuration time and clears the arena on
+	 * reconfiguration therefore touches the heap at most once per capacity
+	 * increase, no matter how often its streams are torn down and set up
+	 * again, and never in any per-period path.
+	 *
+	 * Note that the arena never frees individual allocations; every pointer
+	 * handed out stays valid until the next clear or reserve. It is intended
+	 * for buffers whose lifetime matches the stream configuration, not for
+	 * general purpose allocation.
+	 */
+	class Arena
+	{
+		public:
+
+			/**
+			 * Construct a new arena without backing storage.
+			 */
+			Arena() noexcept : m_data(), m_capacity(0), m_used(0) {}
+
+			/**
+			 * Construct a new arena with the given capacity.
+			 */
+			explicit Arena(std::size_t capacity) : m_data(new char[capacity]), m_capacity(capacity), m_used(0) {}
+
+			/**
+			 * Return the capacity of the arena in bytes.
+			 */
+			std::size_t capacity() const noexcept { return m_capacity; }
+
+			/**
+			 * Return the number of bytes allocated from the arena, including
+			 * alignment padding.
+			 */
+			std::size_t used() const noexcept { return m_used; }
+
+			/**
+			 * Ensure that the arena can serve at least the given capacity. The
+			 * backing storage is reallocated only when the given capacity
+			 * exceeds the current one, so repeated reconfiguration with the
+			 * same demand incurs no heap traffic at all. Throws logic error
+			 * when the arena still has outstanding allocations, since growing
+			 * the slab would invalidate them.
+			 */
+			void reserve(std::size_t capacity)
+			{
+				if (m_used > 0) {
+					Exception::start(std::logic_error("[Support::Arena::reserve] arena should be cleared before growing"), "arena.hpp", __LINE__);
+				} else if (capacity > m_capacity) {
+					m_data.reset(new char[capacity]);
+					m_capacity = capacity;
+				}
+			}
+
+			/**
+			 * Allocate the given number of bytes from the arena and return a
+			 * pointer to the start of the allocation. Each allocation is
+			 * aligned for any scalar type. Throws length error when the
+			 * remaining capacity cannot serve the allocation.
+			 */
+			char* allocate(std::size_t size)
+			{
+				const std::size_t alignment = alignof(std::max_align_t);
+				const std::size_t padding = (m_used % alignment > 0 ? alignment - m_used % alignment : 0);
+				const std::size_t offset = m_used + padding;
+
+				if (size == 0) {
+					Exception::start(std::invalid_argument("[Support::Arena::allocate] size should not be 0"), "arena.hpp", __LINE__);
+				} else if (offset > m_capacity || size > m_capacity - offset) {
+					Exception::start(std::length_error("[Support::Arena::allocate] Cannot allocate from arena due to exhausted capacity"), "arena.hpp", __LINE__);
+				}
+
+				m_used = offset + size;
+				return m_data.get() + offset;
+			}
+
+			/**
+			 * Release every allocation in the arena at once. The backing
+			 * storage is retained for reuse.
+			 */
+			void clear() noexcept
+			{
+				m_used = 0;
+			}
+
+			/**
+			 * Construct a new arena by taking over the backing storage of
+			 * another arena. The other arena is left without backing storage.
+			 */
+			Arena(Arena&& arena) noexcept : m_data(std::move(arena.m_data)), m_capacity(arena.m_capacity), m_used(arena.m_used)
+			{
+				arena.m_capacity = 0;
+				arena.m_used = 0;
+			}
+
+			/**
+			 * Replace the backing storage of the arena with the one taken over
+			 * from another arena. The other arena is left without backing
+			 * storage.
+			 */
+			Arena& operator=(Arena&& arena) noexcept
+			{
+				m_data = std::move(arena.m_data);
+				m_capacity = arena.m_capacity;
+				m_used = arena.m_used;
+				arena.m_capacity = 0;
+				arena.m_used = 0;
+				return *this;
+			}
+
+			Arena(const Arena& arena) = delete;
+			Arena& operator=(const Arena& arena) = delete;
+
+		private:
+
+			/**
+			 * Backing storage of the arena.
+			 */
+			std::unique_ptr<char[]> m_data;
+
+			/**
+			 * Capacity of the backing storage in bytes.
+			 */
+			std::size_t m_capacity;
+
+			/**
+			 * Number of bytes allocated from the backing storage.
+			 */
+			std::size_t m_used;
+
+	};
+
+}
+
+
+#endif
+
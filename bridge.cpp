@@ -0,0 +1,286 @@
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <system_error>
+
+#include <errno.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include "exception.hpp"
+#include "timestamp.hpp"
+#include "buffer.hpp"
+#include "pipe.hpp"
+#include "tokenbucket.hpp"
+#include "operation.hpp"
+#include "bridge.hpp"
+
+
+#define EXC_SYSTEM(err) std::system_error(err, std::system_category(), strerror(err))
+#define EXC_START(...) Support::Exception::start(__VA_ARGS__, "bridge.cpp", __LINE__)
+#define EXC_CHAIN(...) Support::Exception::chain(__VA_ARGS__, "bridge.cpp", __LINE__);
+
+
+namespace Piper
+{
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Helper functions.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	/**
+	 * Create a UDP socket connected to the given host and service. The
+	 * function will throw exception when the host and service cannot be
+	 * resolved or when the socket cannot be created.
+	 */
+	static int create_send_socket(const char* host, const char* service)
+	{
+		struct addrinfo hints;
+		struct addrinfo* result = nullptr;
+
+		std::memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_DGRAM;
+		hints.ai_protocol = IPPROTO_UDP;
+
+		if (::getaddrinfo(host, service, &hints, &result) != 0) {
+			EXC_START(BridgeException("[Piper::create_send_socket] Cannot create socket due to unresolvable host or service"));
+		}
+
+		int descriptor = ::socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+
+		if (descriptor < 0) {
+			int error = errno;
+			::freeaddrinfo(result);
+			EXC_START(EXC_SYSTEM(error), BridgeException("[Piper::create_send_socket] Cannot create socket due to operating system error"));
+		}
+
+		if (::connect(descriptor, result->ai_addr, result->ai_addrlen) < 0) {
+			int error = errno;
+			::close(descriptor);
+			::freeaddrinfo(result);
+			EXC_START(EXC_SYSTEM(error), BridgeException("[Piper::create_send_socket] Cannot connect socket due to operating system error"));
+		}
+
+		::freeaddrinfo(result);
+		return descriptor;
+	}
+
+	/**
+	 * Create a UDP socket bound to the given service on the wildcard
+	 * address. The function will throw exception when the service cannot be
+	 * resolved or when the socket cannot be created.
+	 */
+	static int create_receive_socket(const char* service)
+	{
+		struct addrinfo hints;
+		struct addrinfo* result = nullptr;
+
+		std::memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_DGRAM;
+		hints.ai_protocol = IPPROTO_UDP;
+		hints.ai_flags = AI_PASSIVE;
+
+		if (::getaddrinfo(nullptr, service, &hints, &result) != 0) {
+			EXC_START(BridgeException("[Piper::create_receive_socket] Cannot create socket due to unresolvable service"));
+		}
+
+		int descriptor = ::socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+
+		if (descriptor < 0) {
+			int error = errno;
+			::freeaddrinfo(result);
+			EXC_START(EXC_SYSTEM(error), BridgeException("[Piper::create_receive_socket] Cannot create socket due to operating system error"));
+		}
+
+		if (::bind(descriptor, result->ai_addr, result->ai_addrlen) < 0) {
+			int error = errno;
+			::close(descriptor);
+			::freeaddrinfo(result);
+			EXC_START(EXC_SYSTEM(error), BridgeException("[Piper::create_receive_socket] Cannot bind socket due to operating system error"));
+		}
+
+		::freeaddrinfo(result);
+		return descriptor;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Send operation implementation.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	[[ noreturn ]] void SendOperation::execute(Pipe& pipe, const char* host, const char* service)
+	{
+		Outlet outlet(pipe);
+		Outlet::Position cursor(outlet.until());
+		TokenBucket bucket(10, 1, pipe.period_time());
+		Statistics* statistics = pipe.statistics();
+		int descriptor = create_send_socket(host, service);
+
+		try {
+			bucket.start(now());
+
+			while (true) {
+				if (bucket.tokens() == 0) {
+					bucket.try_refill();
+					m_callback.on_tick();
+				} else if (outlet.until() == cursor) {
+					outlet.watch();
+					m_callback.on_tick();
+				} else if (outlet.start() <= cursor) {
+					unsigned int tokens = bucket.tokens();
+					unsigned int batch = 1;
+					struct mmsghdr messages[16];
+					struct iovec vectors[16][2];
+
+					while (batch < tokens && batch < 16 && cursor + batch < outlet.until()) {
+						batch += 1;
+					}
+
+					std::memset(messages, 0, sizeof(messages));
+
+					for (unsigned int i = 0; i < batch; i++) {
+						const Preamble& preamble(outlet.preamble(cursor + i));
+						const Buffer content(outlet.content(cursor + i));
+
+						vectors[i][0].iov_base = const_cast<Preamble*>(&preamble);
+						vectors[i][0].iov_len = sizeof(Preamble);
+						vectors[i][1].iov_base = const_cast<char*>(content.start());
+						vectors[i][1].iov_len = content.size();
+						messages[i].msg_hdr.msg_iov = vectors[i];
+						messages[i].msg_hdr.msg_iovlen = 2;
+					}
+
+					unsigned int sent = 0;
+
+					while (sent < batch) {
+						int done = ::sendmmsg(descriptor, messages + sent, batch - sent, 0);
+
+						if (done > 0) {
+							sent += static_cast<unsigned int>(done);
+							m_callback.on_tick();
+						} else if (errno == EINTR) {
+							m_callback.on_tick();
+						} else {
+							EXC_START(EXC_SYSTEM(errno), BridgeException("[Piper::SendOperation::execute] Cannot send block due to operating system error"));
+						}
+					}
+
+					for (unsigned int i = 0; i < batch; i++) {
+						const Preamble& preamble(outlet.preamble(cursor + i));
+
+						if (statistics != nullptr) {
+							statistics->reads.fetch_add(1, std::memory_order_relaxed);
+							statistics->latencies[latency_bucket(now() - preamble.timestamp)].fetch_add(1, std::memory_order_relaxed);
+						}
+
+						m_callback.on_transfer(preamble, outlet.content(cursor + i));
+					}
+
+					bucket.spend(batch);
+					cursor += batch;
+					outlet.mark(cursor);
+				} else {
+					if (statistics != nullptr) {
+						statistics->overruns.fetch_add(1, std::memory_order_relaxed);
+					}
+
+					cursor = outlet.until();
+					outlet.mark(cursor);
+				}
+			}
+		} catch (std::exception& ex) {
+			m_callback.on_end();
+			bucket.stop();
+			::close(descriptor);
+			throw;
+		} catch (...) {
+			m_callback.on_end();
+			bucket.stop();
+			::close(descriptor);
+			throw;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Receive operation implementation.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	[[ noreturn ]] void ReceiveOperation::execute(Pipe& pipe, const char* service)
+	{
+		Inlet inlet(pipe);
+		const std::size_t period_size = pipe.period_size();
+		int descriptor = create_receive_socket(service);
+
+		try {
+			while (true) {
+				Inlet::Position cursor(inlet.start());
+				unsigned int batch = 1;
+				struct mmsghdr messages[16];
+				struct iovec vectors[16][2];
+
+				while (batch < 16 && cursor + batch < inlet.until()) {
+					batch += 1;
+				}
+
+				std::memset(messages, 0, sizeof(messages));
+
+				for (unsigned int i = 0; i < batch; i++) {
+					vectors[i][0].iov_base = &inlet.preamble(cursor + i);
+					vectors[i][0].iov_len = sizeof(Preamble);
+					vectors[i][1].iov_base = inlet.content(cursor + i).start();
+					vectors[i][1].iov_len = period_size;
+					messages[i].msg_hdr.msg_iov = vectors[i];
+					messages[i].msg_hdr.msg_iovlen = 2;
+				}
+
+				int count = ::recvmmsg(descriptor, messages, batch, MSG_WAITFORONE, nullptr);
+
+				if (count > 0) {
+					for (int i = 0; i < count; i++) {
+						if (messages[i].msg_len != sizeof(Preamble) + period_size) {
+							break;
+						}
+
+						Preamble& preamble(inlet.preamble(cursor));
+
+						preamble.timestamp = now();
+						m_callback.on_transfer(preamble, inlet.content(cursor));
+						inlet.flush();
+						cursor += 1;
+					}
+
+					m_callback.on_tick();
+				} else if (errno == EINTR) {
+					m_callback.on_tick();
+				} else {
+					EXC_START(EXC_SYSTEM(errno), BridgeException("[Piper::ReceiveOperation::execute] Cannot receive block due to operating system error"));
+				}
+			}
+		} catch (std::exception& ex) {
+			m_callback.on_end();
+			::close(descriptor);
+			throw;
+		} catch (...) {
+			m_callback.on_end();
+			::close(descriptor);
+			throw;
+		}
+	}
+
+}
+
+
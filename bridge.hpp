@@ -0,0 +1,149 @@
+
+
+#include <exception>
+#include <stdexcept>
+
+#include "buffer.hpp"
+#include "pipe.hpp"
+#include "operation.hpp"
+
+
+#ifndef BRIDGE_HPP_
+#define BRIDGE_HPP_
+
+
+namespace Piper
+{
+
+	/**
+	 * Send operation streams blocks from a pipe to a remote host over UDP.
+	 *
+	 * Implementation Details
+	 * ======================
+	 *
+	 * The operation creates an outlet to the pipe and a UDP socket connected
+	 * to the given host and service, then runs a transfer loop paced by a
+	 * token bucket over the pipe period time, mirroring the drain operation.
+	 *
+	 * Each readable block is sent as a single datagram carrying the block
+	 * preamble followed by the block content, so the wire framing matches
+	 * the component layout of the backing file and the receive operation
+	 * can deposit the datagram straight into its own pipe. The readable
+	 * blocks of a whole batch are sent with a single sendmmsg(2) call, so
+	 * bursts of pending blocks cost one system call instead of one per
+	 * block.
+	 *
+	 * When the operation falls behind the capacity of the pipe, it is
+	 * resynchronized to the current write position instead of failing, and
+	 * the dropped periods are recorded in the overrun counter of the pipe.
+	 *
+	 * Throughout the operation, appropriate callback will be invoked to
+	 * report the progress. They can be used to stop the operation by
+	 * throwing exceptions.
+	 */
+	class SendOperation
+	{
+		public:
+
+			/**
+			 * Construct a new send operation.
+			 */
+			explicit SendOperation(Callback& callback) : m_callback(callback) {}
+
+			/**
+			 * Get the callback used in the send operation.
+			 */
+			const Callback& callback() const noexcept { return m_callback; }
+
+			/**
+			 * Execute the send operation, streaming blocks from the given pipe
+			 * to the given host and service. Note that any exception thrown by
+			 * the callback will stop the operation and it will then be rethrown
+			 * verbatim.
+			 */
+			void execute(Pipe& pipe, const char* host, const char* service);
+
+		private:
+
+			/**
+			 * Callback invoked during the operation.
+			 */
+			Callback& m_callback;
+
+	};
+
+	/**
+	 * Receive operation accepts blocks streamed by a send operation and
+	 * feeds them into a pipe.
+	 *
+	 * Implementation Details
+	 * ======================
+	 *
+	 * The operation creates an inlet to the pipe and a UDP socket bound to
+	 * the given service, then receives datagrams directly into the staging
+	 * blocks of the inlet with recvmmsg(2), so the preamble and content of
+	 * each block land in the backing file without staging copies. Each
+	 * complete datagram is then flushed into the pipe in arrival order.
+	 *
+	 * Datagrams whose size does not match a block are dropped, along with
+	 * the rest of their batch; the staging blocks they touched are reused
+	 * by the next receive, so malformed traffic cannot corrupt the pipe.
+	 *
+	 * The block timestamps are rewritten on arrival, because the monotonic
+	 * clock of the sending host is not comparable to the local one. The
+	 * flags of the preamble are forwarded verbatim, so silent blocks stay
+	 * marked across the bridge. Jitter between arrivals is absorbed by the
+	 * read window of the pipe and the prebuffer of the local drain client,
+	 * just as it is for a local feed client.
+	 *
+	 * Throughout the operation, appropriate callback will be invoked to
+	 * report the progress. They can be used to stop the operation by
+	 * throwing exceptions.
+	 */
+	class ReceiveOperation
+	{
+		public:
+
+			/**
+			 * Construct a new receive operation.
+			 */
+			explicit ReceiveOperation(Callback& callback) : m_callback(callback) {}
+
+			/**
+			 * Get the callback used in the receive operation.
+			 */
+			const Callback& callback() const noexcept { return m_callback; }
+
+			/**
+			 * Execute the receive operation, feeding the given pipe with blocks
+			 * received on the given service. Note that any exception thrown by
+			 * the callback will stop the operation and it will then be rethrown
+			 * verbatim.
+			 */
+			void execute(Pipe& pipe, const char* service);
+
+		private:
+
+			/**
+			 * Callback invoked during the operation.
+			 */
+			Callback& m_callback;
+
+	};
+
+	/**
+	 * Exception thrown when a bridge operation cannot resolve, create or
+	 * use its socket.
+	 */
+	class BridgeException : public std::runtime_error
+	{
+		public:
+			using std::runtime_error::runtime_error;
+	};
+
+}
+
+
+#endif
+
+
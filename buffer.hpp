@@ -8,6 +8,9 @@
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
+#include <vector>
+
+#include <sys/uio.h>
 
 #include "exception.hpp"
 
@@ -467,6 +470,283 @@ namespace Piper
 
 	};
 
+	/**
+	 * GatherSource implements a multi-buffer counterpart of Source for
+	 * vectored I/O. It represents a sequence of possibly non-contiguous
+	 * buffers where data can be read from, together with a counter
+	 * indicating the amount of pending data across all of them.
+	 *
+	 * The gather method exports the unread data as an iovec array, so a
+	 * consumer can move the content of every buffer in a single writev(2)
+	 * style call; consumers without vectored transfer support can instead
+	 * process the data method one segment at a time.
+	 */
+	class GatherSource
+	{
+		public:
+
+			/**
+			 * Construct a new empty gather source.
+			 */
+			explicit GatherSource() : m_buffers(), m_index(0), m_offset(0), m_total(0), m_remainder(0)
+			{
+				// do nothing
+			}
+
+			/**
+			 * Append the given buffer as the next segment of the source.
+			 */
+			void append(const Buffer& buffer)
+			{
+				m_buffers.push_back(buffer);
+				m_total += buffer.size();
+				m_remainder += buffer.size();
+			}
+
+			/**
+			 * Return the number of segments in the source.
+			 */
+			std::size_t segments() const noexcept
+			{
+				return m_buffers.size();
+			}
+
+			/**
+			 * Return the number of bytes that are available for reading.
+			 */
+			std::size_t total() const noexcept
+			{
+				return m_total;
+			}
+
+			/**
+			 * Return the number of bytes that are already read.
+			 */
+			std::size_t read() const noexcept
+			{
+				return m_total - m_remainder;
+			}
+
+			/**
+			 * Return the number of bytes in the segments to be read.
+			 */
+			std::size_t remainder() const noexcept
+			{
+				return m_remainder;
+			}
+
+			/**
+			 * Return a buffer containing the unread data of the current segment.
+			 * Throws exception when there are no data left.
+			 */
+			const Buffer data() const
+			{
+				if (m_remainder == 0) {
+					Support::Exception::start(std::out_of_range("[Piper::GatherSource::data] data should not be called on a finished source"), "buffer.hpp", __LINE__);
+				}
+
+				return m_buffers[m_index].slice(m_offset, m_buffers[m_index].size() - m_offset);
+			}
+
+			/**
+			 * Fill the given iovec array with the unread data of the source and
+			 * return the number of entries filled. At most limit entries are
+			 * filled; remaining data past the limit are simply left out.
+			 */
+			std::size_t gather(struct iovec* vector, std::size_t limit) const
+			{
+				std::size_t offset = m_offset;
+				std::size_t count = 0;
+
+				for (std::size_t index = m_index; index < m_buffers.size() && count < limit; index++) {
+					const Buffer& buffer(m_buffers[index]);
+
+					if (offset < buffer.size()) {
+						vector[count].iov_base = const_cast<char*>(buffer.start()) + offset;
+						vector[count].iov_len = buffer.size() - offset;
+						count += 1;
+					}
+
+					offset = 0;
+				}
+
+				return count;
+			}
+
+			/**
+			 * Consume the given amount of data as processed.
+			 */
+			void consume(std::size_t consumed)
+			{
+				if (consumed > m_remainder) {
+					Support::Exception::start(std::out_of_range("[Piper::GatherSource::consume] consumed should not exceed remainder size"), "buffer.hpp", __LINE__);
+				}
+
+				m_remainder -= consumed;
+
+				while (consumed > 0) {
+					std::size_t available = m_buffers[m_index].size() - m_offset;
+
+					if (consumed < available) {
+						m_offset += consumed;
+						consumed = 0;
+					} else {
+						consumed -= available;
+						m_index += 1;
+						m_offset = 0;
+					}
+				}
+			}
+
+		private:
+
+			std::vector<Buffer> m_buffers;
+			std::size_t m_index;
+			std::size_t m_offset;
+			std::size_t m_total;
+			std::size_t m_remainder;
+
+	};
+
+	/**
+	 * ScatterDestination implements a multi-buffer counterpart of
+	 * Destination for vectored I/O. It represents a sequence of possibly
+	 * non-contiguous buffers where data can be written to, together with a
+	 * counter indicating the amount of unused space across all of them.
+	 *
+	 * The scatter method exports the unused space as an iovec array, so a
+	 * producer can fill every buffer in a single readv(2) style call;
+	 * producers without vectored transfer support can instead process the
+	 * data method one segment at a time.
+	 */
+	class ScatterDestination
+	{
+		public:
+
+			/**
+			 * Construct a new empty scatter destination.
+			 */
+			explicit ScatterDestination() : m_buffers(), m_index(0), m_offset(0), m_total(0), m_remainder(0)
+			{
+				// do nothing
+			}
+
+			/**
+			 * Append the given buffer as the next segment of the destination.
+			 */
+			void append(const Buffer& buffer)
+			{
+				m_buffers.push_back(buffer);
+				m_total += buffer.size();
+				m_remainder += buffer.size();
+			}
+
+			/**
+			 * Return the number of segments in the destination.
+			 */
+			std::size_t segments() const noexcept
+			{
+				return m_buffers.size();
+			}
+
+			/**
+			 * Return the number of bytes that are available for processing.
+			 */
+			std::size_t total() const noexcept
+			{
+				return m_total;
+			}
+
+			/**
+			 * Return the number of bytes that are already written.
+			 */
+			std::size_t written() const noexcept
+			{
+				return m_total - m_remainder;
+			}
+
+			/**
+			 * Return the number of bytes in the segments to be written.
+			 */
+			std::size_t remainder() const noexcept
+			{
+				return m_remainder;
+			}
+
+			/**
+			 * Return a buffer containing the unused space of the current
+			 * segment. Throws exception when there are no space left.
+			 */
+			Buffer data()
+			{
+				if (m_remainder == 0) {
+					Support::Exception::start(std::out_of_range("[Piper::ScatterDestination::data] data should not be called on a finished destination"), "buffer.hpp", __LINE__);
+				}
+
+				return m_buffers[m_index].slice(m_offset, m_buffers[m_index].size() - m_offset);
+			}
+
+			/**
+			 * Fill the given iovec array with the unused space of the
+			 * destination and return the number of entries filled. At most
+			 * limit entries are filled; remaining space past the limit are
+			 * simply left out.
+			 */
+			std::size_t scatter(struct iovec* vector, std::size_t limit)
+			{
+				std::size_t offset = m_offset;
+				std::size_t count = 0;
+
+				for (std::size_t index = m_index; index < m_buffers.size() && count < limit; index++) {
+					Buffer& buffer(m_buffers[index]);
+
+					if (offset < buffer.size()) {
+						vector[count].iov_base = buffer.start() + offset;
+						vector[count].iov_len = buffer.size() - offset;
+						count += 1;
+					}
+
+					offset = 0;
+				}
+
+				return count;
+			}
+
+			/**
+			 * Consume the given amount of space as processed.
+			 */
+			void consume(std::size_t consumed)
+			{
+				if (consumed > m_remainder) {
+					Support::Exception::start(std::out_of_range("[Piper::ScatterDestination::consume] consumed should not exceed remainder size"), "buffer.hpp", __LINE__);
+				}
+
+				m_remainder -= consumed;
+
+				while (consumed > 0) {
+					std::size_t available = m_buffers[m_index].size() - m_offset;
+
+					if (consumed < available) {
+						m_offset += consumed;
+						consumed = 0;
+					} else {
+						consumed -= available;
+						m_index += 1;
+						m_offset = 0;
+					}
+				}
+			}
+
+		private:
+
+			std::vector<Buffer> m_buffers;
+			std::size_t m_index;
+			std::size_t m_offset;
+			std::size_t m_total;
+			std::size_t m_remainder;
+
+	};
+
 	/**
 	 * Copy data from the source buffer into the destination buffer.
 	 */
@@ -0,0 +1,235 @@
+
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+
+#include <alsa/asoundlib.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "exception.hpp"
+#include "buffer.hpp"
+#include "convert.hpp"
+
+
+#define EXC_START(...) Support::Exception::start(__VA_ARGS__, "convert.cpp", __LINE__)
+#define EXC_CHAIN(...) Support::Exception::chain(__VA_ARGS__, "convert.cpp", __LINE__);
+
+
+namespace Piper
+{
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Conversion kernels.
+	//
+	// Each kernel converts a whole run of samples in a single pass. On SSE2
+	// capable targets the bulk of the run is processed in vector registers
+	// and only the tail falls through to the scalar loop; on other targets
+	// the scalar loop handles the whole run.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	static void kernel_s16_to_s32(char* output, const char* input, std::size_t samples)
+	{
+		const std::int16_t* source = reinterpret_cast<const std::int16_t*>(input);
+		std::int32_t* target = reinterpret_cast<std::int32_t*>(output);
+		std::size_t index = 0;
+
+#if defined(__SSE2__)
+		for (; index + 8 <= samples; index += 8) {
+			__m128i zero = _mm_setzero_si128();
+			__m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(target + index), _mm_unpacklo_epi16(zero, data));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(target + index + 4), _mm_unpackhi_epi16(zero, data));
+		}
+#endif
+
+		for (; index < samples; index++) {
+			target[index] = static_cast<std::int32_t>(source[index]) << 16;
+		}
+	}
+
+	static void kernel_s32_to_s16(char* output, const char* input, std::size_t samples)
+	{
+		const std::int32_t* source = reinterpret_cast<const std::int32_t*>(input);
+		std::int16_t* target = reinterpret_cast<std::int16_t*>(output);
+		std::size_t index = 0;
+
+#if defined(__SSE2__)
+		for (; index + 8 <= samples; index += 8) {
+			__m128i head = _mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index)), 16);
+			__m128i tail = _mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index + 4)), 16);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(target + index), _mm_packs_epi32(head, tail));
+		}
+#endif
+
+		for (; index < samples; index++) {
+			target[index] = static_cast<std::int16_t>(source[index] >> 16);
+		}
+	}
+
+	static void kernel_s16_to_f32(char* output, const char* input, std::size_t samples)
+	{
+		const std::int16_t* source = reinterpret_cast<const std::int16_t*>(input);
+		float* target = reinterpret_cast<float*>(output);
+		std::size_t index = 0;
+
+#if defined(__SSE2__)
+		for (; index + 8 <= samples; index += 8) {
+			__m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+			__m128i zero = _mm_setzero_si128();
+			__m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index));
+			_mm_storeu_ps(target + index, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(zero, data)), scale));
+			_mm_storeu_ps(target + index + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(zero, data)), scale));
+		}
+#endif
+
+		for (; index < samples; index++) {
+			target[index] = static_cast<float>(source[index]) * (1.0f / 32768.0f);
+		}
+	}
+
+	static void kernel_f32_to_s16(char* output, const char* input, std::size_t samples)
+	{
+		const float* source = reinterpret_cast<const float*>(input);
+		std::int16_t* target = reinterpret_cast<std::int16_t*>(output);
+		std::size_t index = 0;
+
+#if defined(__SSE2__)
+		for (; index + 8 <= samples; index += 8) {
+			__m128 scale = _mm_set1_ps(32768.0f);
+			__m128i head = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(source + index), scale));
+			__m128i tail = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(source + index + 4), scale));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(target + index), _mm_packs_epi32(head, tail));
+		}
+#endif
+
+		for (; index < samples; index++) {
+			long value = std::lrintf(source[index] * 32768.0f);
+			value = (value > 32767 ? 32767 : value);
+			value = (value < -32768 ? -32768 : value);
+			target[index] = static_cast<std::int16_t>(value);
+		}
+	}
+
+	static void kernel_swap16(char* output, const char* input, std::size_t samples)
+	{
+		const std::uint16_t* source = reinterpret_cast<const std::uint16_t*>(input);
+		std::uint16_t* target = reinterpret_cast<std::uint16_t*>(output);
+		std::size_t index = 0;
+
+#if defined(__SSE2__)
+		for (; index + 8 <= samples; index += 8) {
+			__m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(target + index), _mm_or_si128(_mm_slli_epi16(data, 8), _mm_srli_epi16(data, 8)));
+		}
+#endif
+
+		for (; index < samples; index++) {
+			target[index] = __builtin_bswap16(source[index]);
+		}
+	}
+
+	static void kernel_swap32(char* output, const char* input, std::size_t samples)
+	{
+		const std::uint32_t* source = reinterpret_cast<const std::uint32_t*>(input);
+		std::uint32_t* target = reinterpret_cast<std::uint32_t*>(output);
+		std::size_t index = 0;
+
+#if defined(__SSE2__)
+		for (; index + 4 <= samples; index += 4) {
+			__m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index));
+			__m128i half = _mm_or_si128(_mm_slli_epi16(data, 8), _mm_srli_epi16(data, 8));
+			__m128i full = _mm_or_si128(_mm_slli_epi32(half, 16), _mm_srli_epi32(half, 16));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(target + index), full);
+		}
+#endif
+
+		for (; index < samples; index++) {
+			target[index] = __builtin_bswap32(source[index]);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Converter implementation.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	static inline std::size_t sample_size(snd_pcm_format_t format)
+	{
+		int width = snd_pcm_format_physical_width(format);
+
+		if (width > 0 && width % 8 == 0) {
+			return static_cast<std::size_t>(width / 8);
+		} else {
+			EXC_START(std::invalid_argument("[Piper::sample_size] Cannot calculate sample size due to invalid format"));
+		}
+	}
+
+	Converter::Converter(snd_pcm_format_t input, snd_pcm_format_t output) :
+		m_input(input),
+		m_output(output),
+		m_input_size(sample_size(input)),
+		m_output_size(sample_size(output)),
+		m_kernel(nullptr)
+	{
+		if (input == output) {
+			m_kernel = nullptr;
+		} else if (input == SND_PCM_FORMAT_S16_LE && output == SND_PCM_FORMAT_S32_LE) {
+			m_kernel = kernel_s16_to_s32;
+		} else if (input == SND_PCM_FORMAT_S32_LE && output == SND_PCM_FORMAT_S16_LE) {
+			m_kernel = kernel_s32_to_s16;
+		} else if (input == SND_PCM_FORMAT_S16_LE && output == SND_PCM_FORMAT_FLOAT_LE) {
+			m_kernel = kernel_s16_to_f32;
+		} else if (input == SND_PCM_FORMAT_FLOAT_LE && output == SND_PCM_FORMAT_S16_LE) {
+			m_kernel = kernel_f32_to_s16;
+		} else if (input == SND_PCM_FORMAT_S16_LE && output == SND_PCM_FORMAT_S16_BE) {
+			m_kernel = kernel_swap16;
+		} else if (input == SND_PCM_FORMAT_S16_BE && output == SND_PCM_FORMAT_S16_LE) {
+			m_kernel = kernel_swap16;
+		} else if (input == SND_PCM_FORMAT_S32_LE && output == SND_PCM_FORMAT_S32_BE) {
+			m_kernel = kernel_swap32;
+		} else if (input == SND_PCM_FORMAT_S32_BE && output == SND_PCM_FORMAT_S32_LE) {
+			m_kernel = kernel_swap32;
+		} else {
+			EXC_START(UnsupportedConversionException("[Piper::Converter::Converter] Cannot create converter due to unsupported conversion"));
+		}
+	}
+
+	std::size_t Converter::length(std::size_t size) const
+	{
+		if (size % m_input_size != 0) {
+			EXC_START(std::invalid_argument("[Piper::Converter::length] Cannot calculate output length due to partial sample in input"));
+		} else {
+			return (size / m_input_size) * m_output_size;
+		}
+	}
+
+	void Converter::convert(Buffer& output, const Buffer& input) const
+	{
+		if (input.size() % m_input_size != 0) {
+			EXC_START(std::invalid_argument("[Piper::Converter::convert] Cannot convert buffer due to partial sample in input"));
+		}
+
+		std::size_t samples = input.size() / m_input_size;
+
+		if (output.size() < samples * m_output_size) {
+			EXC_START(std::invalid_argument("[Piper::Converter::convert] Cannot convert buffer due to insufficient output space"));
+		} else if (m_kernel == nullptr) {
+			std::memcpy(output.start(), input.start(), input.size());
+		} else {
+			m_kernel(output.start(), input.start(), samples);
+		}
+	}
+
+}
+
+
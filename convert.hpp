@@ -0,0 +1,143 @@
+
+
+#include <cstddef>
+#include <exception>
+#include <stdexcept>
+
+#include <alsa/asoundlib.h>
+
+#include "buffer.hpp"
+
+
+#ifndef CONVERT_HPP_
+#define CONVERT_HPP_
+
+
+namespace Piper
+{
+
+	/**
+	 * Converter implements a sample format conversion stage between a pipe
+	 * and a device.
+	 *
+	 * Pipes are created with a single fixed sample format and normally the
+	 * devices have to match it exactly. When they cannot, a converter can be
+	 * placed between the two: a drain client would convert each block from
+	 * the outlet into the device buffer, and a feed client would convert
+	 * data from the device into the inlet block, each in a single pass over
+	 * the period without any extra staging buffer.
+	 *
+	 * The converter supports the common conversions between the linear
+	 * little endian formats S16, S32 and FLOAT, plus byte order swaps for
+	 * the S16 and S32 formats. The conversion kernels process the whole
+	 * buffer in one call and use SSE2 vector code where the target supports
+	 * it, falling back to portable scalar code elsewhere.
+	 */
+	class Converter
+	{
+		public:
+
+			/**
+			 * Construct a new converter between the given input and output
+			 * formats. Throws an unsupported conversion exception when the
+			 * conversion between the formats is not implemented.
+			 */
+			explicit Converter(snd_pcm_format_t input, snd_pcm_format_t output);
+
+			/**
+			 * Return the input format of the converter.
+			 */
+			snd_pcm_format_t input() const noexcept { return m_input; }
+
+			/**
+			 * Return the output format of the converter.
+			 */
+			snd_pcm_format_t output() const noexcept { return m_output; }
+
+			/**
+			 * Return the size of a single input sample in bytes.
+			 */
+			std::size_t input_sample_size() const noexcept { return m_input_size; }
+
+			/**
+			 * Return the size of a single output sample in bytes.
+			 */
+			std::size_t output_sample_size() const noexcept { return m_output_size; }
+
+			/**
+			 * Return the amount of output space in bytes needed to convert input
+			 * of the given size. Throws an invalid argument exception when the
+			 * given size contains a partial sample.
+			 */
+			std::size_t length(std::size_t size) const;
+
+			/**
+			 * Convert every sample in the input buffer and store the results in
+			 * the output buffer. Throws an invalid argument exception when the
+			 * input buffer contains a partial sample or when the output buffer
+			 * is too small for the converted data.
+			 */
+			void convert(Buffer& output, const Buffer& input) const;
+
+		private:
+
+			/**
+			 * Signature of conversion kernels. A kernel converts the given number
+			 * of samples from the input pointer to the output pointer.
+			 */
+			typedef void (*Kernel)(char* output, const char* input, std::size_t samples);
+
+			/**
+			 * Input format of the converter.
+			 */
+			snd_pcm_format_t m_input;
+
+			/**
+			 * Output format of the converter.
+			 */
+			snd_pcm_format_t m_output;
+
+			/**
+			 * Size of a single input sample in bytes.
+			 */
+			std::size_t m_input_size;
+
+			/**
+			 * Size of a single output sample in bytes.
+			 */
+			std::size_t m_output_size;
+
+			/**
+			 * Kernel implementing the conversion. A null kernel indicates that
+			 * input and output formats are identical and data is copied without
+			 * conversion.
+			 */
+			Kernel m_kernel;
+
+	};
+
+	/**
+	 * Exception thrown for any converter errors.
+	 */
+	class ConvertException : public std::runtime_error
+	{
+		public:
+			using std::runtime_error::runtime_error;
+	};
+
+	/**
+	 * Exception thrown when the conversion between the requested formats is
+	 * not implemented by the converter.
+	 */
+	class UnsupportedConversionException : public ConvertException
+	{
+		public:
+			using ConvertException::ConvertException;
+	};
+
+}
+
+
+#endif
+
+
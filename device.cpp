@@ -12,6 +12,7 @@
 #include <alsa/asoundlib.h>
 
 #include "exception.hpp"
+#include "arena.hpp"
 #include "buffer.hpp"
 #include "file.hpp"
 #include "pipe.hpp"
@@ -26,6 +27,44 @@
 namespace Piper
 {
 
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Device base class implementation.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	void PlaybackDevice::try_write(GatherSource& source)
+	{
+		while (source.remainder() > 0) {
+			const Buffer slice(source.data());
+			Source segment(slice);
+
+			try_write(segment);
+
+			if (segment.read() == 0) {
+				return;
+			}
+
+			source.consume(segment.read());
+		}
+	}
+
+	void CaptureDevice::try_read(ScatterDestination& destination)
+	{
+		while (destination.remainder() > 0) {
+			Buffer slice(destination.data());
+			Destination segment(slice);
+
+			try_read(segment);
+
+			if (segment.written() == 0) {
+				return;
+			}
+
+			destination.consume(segment.written());
+		}
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 	//
 	// Standard output playback device implementation.
@@ -33,8 +72,14 @@ namespace Piper
 	//////////////////////////////////////////////////////////////////////////
 
 	StdoutPlaybackDevice::StdoutPlaybackDevice() :
-		m_file(STDOUT_FILENO)
+		m_file(STDOUT_FILENO),
+		m_ring()
 	{
+		try {
+			m_ring.reset(new Ring(8));
+		} catch (RingUnsupportedException& ex) {
+			m_ring.reset();
+		}
 	}
 
 	void StdoutPlaybackDevice::write(const Buffer buffer)
@@ -53,6 +98,27 @@ namespace Piper
 	}
 
 	void StdoutPlaybackDevice::try_write(Source& source)
+	{
+		try {
+			if (m_ring != nullptr) {
+				m_ring->write(m_file.descriptor(), source);
+			} else {
+				m_file.try_writeall(source, -1);
+			}
+		} catch (RingException& ex) {
+			EXC_CHAIN(DevicePlaybackException("[Piper::StdoutPlaybackDevice::try_write] Cannot write to device due to IO error"));
+		} catch (FileIOException& ex) {
+			EXC_CHAIN(DevicePlaybackException("[Piper::StdoutPlaybackDevice::try_write] Cannot write to device due to IO error"));
+		} catch (EndOfFileException& ex) {
+			EXC_CHAIN(DeviceUnusableException("[Piper::StdoutPlaybackDevice::try_write] Cannot write to device due to end of file"));
+		} catch (FileNotWritableException& ex) {
+			EXC_CHAIN(std::logic_error("[Piper::StdoutPlaybackDevice::try_write] Cannot write to device due to unwritable stdout"));
+		} catch (std::logic_error& ex) {
+			EXC_CHAIN(std::logic_error("[Piper::StdoutPlaybackDevice::try_write] Cannot write to device due to logic error in underlying component"));
+		}
+	}
+
+	void StdoutPlaybackDevice::try_write(GatherSource& source)
 	{
 		try {
 			m_file.try_writeall(source, -1);
@@ -89,8 +155,14 @@ namespace Piper
 	//////////////////////////////////////////////////////////////////////////
 
 	StdinCaptureDevice::StdinCaptureDevice() :
-		m_file(STDIN_FILENO)
+		m_file(STDIN_FILENO),
+		m_ring()
 	{
+		try {
+			m_ring.reset(new Ring(8));
+		} catch (RingUnsupportedException& ex) {
+			m_ring.reset();
+		}
 	}
 
 	void StdinCaptureDevice::read(Buffer buffer)
@@ -107,6 +179,25 @@ namespace Piper
 	}
 
 	void StdinCaptureDevice::try_read(Destination& destination)
+	{
+		try {
+			if (m_ring != nullptr) {
+				m_ring->read(m_file.descriptor(), destination);
+			} else {
+				m_file.try_readall(destination, -1);
+			}
+		} catch (RingException& ex) {
+			EXC_CHAIN(DeviceCaptureException("[Piper::StdinCaptureDevice::read] Cannot read from device due to IO error"));
+		} catch (FileIOException& ex) {
+			EXC_CHAIN(DevicePlaybackException("[Piper::StdinCaptureDevice::read] Cannot read from device due to IO error"));
+		} catch (FileNotWritableException& ex) {
+			EXC_CHAIN(std::logic_error("[Piper::StdinCaptureDevice::read] Cannot read from device due to unreadable stdin"));
+		} catch (std::logic_error& ex) {
+			EXC_CHAIN(std::logic_error("[Piper::StdinCaptureDevice::read] Cannot read from device due to logic error in underlying component"));
+		}
+	}
+
+	void StdinCaptureDevice::try_read(ScatterDestination& destination)
 	{
 		try {
 			m_file.try_readall(destination, -1);
@@ -203,23 +294,15 @@ namespace Piper
 	AlsaPlaybackDevice::~AlsaPlaybackDevice()
 	{
 		snd_pcm_close(m_handle);
-
-		if (m_partial_data != nullptr) {
-			delete[] m_partial_data;
-			m_partial_data = nullptr;
-		}
 	}
 
 	void AlsaPlaybackDevice::configure(const Pipe& pipe, unsigned int prebuffer)
 	{
-		if (m_partial_data != nullptr) {
-			delete[] m_partial_data;
-			m_partial_data = nullptr;
-		}
-
 		m_frame_size = pipe.frame_size();
 		m_partial_size = 0;
-		m_partial_data = new char[m_frame_size];
+		m_arena.clear();
+		m_arena.reserve(m_frame_size);
+		m_partial_data = m_arena.allocate(m_frame_size);
 
 		snd_pcm_hw_params_t* hwparams = nullptr;
 		snd_pcm_sw_params_t* swparams = nullptr;
@@ -311,34 +394,51 @@ namespace Piper
 	void AlsaPlaybackDevice::try_write(Source& source, int timeout)
 	{
 		if (source.remainder() > 0) {
+			if (m_partial_size == m_frame_size) {
+				if (do_write_alsa_pcm(m_handle, m_partial_data, 1, timeout) == 1) {
+					m_partial_size = 0;
+				} else {
+					return;
+				}
+			}
+
 			Buffer buffer = source.data();
 			const char* start = buffer.start();
 			std::size_t pending = buffer.size();
 
-			if (m_partial_size == m_frame_size) {
-				if (do_write_alsa_pcm(m_handle, m_partial_data, 1, timeout) == 1) {
+			if (m_partial_size > 0) {
+				std::size_t copied = std::min(pending, m_frame_size - m_partial_size);
+				std::memcpy(m_partial_data + m_partial_size, start, copied);
+				m_partial_size += copied;
+				source.consume(copied);
+				start += copied;
+				pending -= copied;
+
+				if (m_partial_size < m_frame_size) {
+					return;
+				} else if (do_write_alsa_pcm(m_handle, m_partial_data, 1, timeout) == 1) {
 					m_partial_size = 0;
-				}
-			} else if (pending > 0) {
-				if (m_partial_size > 0) {
-					std::size_t copied = std::min(pending, m_frame_size - m_partial_size);
-					std::memcpy(m_partial_data + m_partial_size, start, copied);
-					m_partial_size += copied;
-					source.consume(copied);
-
-					if (m_partial_size == m_frame_size) {
-						if (do_write_alsa_pcm(m_handle, m_partial_data, 1, timeout) == 1) {
-							m_partial_size = 0;
-						}
-					}
-				} else if (pending < m_frame_size) {
-					std::memcpy(m_partial_data, start, pending);
-					m_partial_size = pending;
-					source.consume(pending);
 				} else {
-					source.consume(do_write_alsa_pcm(m_handle, start, pending / m_frame_size, timeout) * m_frame_size);
+					return;
 				}
 			}
+
+			if (pending >= m_frame_size) {
+				std::size_t copied = do_write_alsa_pcm(m_handle, start, pending / m_frame_size, timeout) * m_frame_size;
+				source.consume(copied);
+				start += copied;
+				pending -= copied;
+
+				if (copied == 0) {
+					return;
+				}
+			}
+
+			if (pending > 0 && pending < m_frame_size) {
+				std::memcpy(m_partial_data, start, pending);
+				m_partial_size = pending;
+				source.consume(pending);
+			}
 		}
 	}
 
@@ -413,23 +513,15 @@ namespace Piper
 	AlsaCaptureDevice::~AlsaCaptureDevice()
 	{
 		snd_pcm_close(m_handle);
-
-		if (m_partial_data != nullptr) {
-			delete[] m_partial_data;
-			m_partial_data = nullptr;
-		}
 	}
 
 	void AlsaCaptureDevice::configure(const Pipe& pipe)
 	{
-		if (m_partial_data != nullptr) {
-			delete[] m_partial_data;
-			m_partial_data = nullptr;
-		}
-
 		m_frame_size = pipe.frame_size();
 		m_partial_size = 0;
-		m_partial_data = new char[m_frame_size];
+		m_arena.clear();
+		m_arena.reserve(m_frame_size);
+		m_partial_data = m_arena.allocate(m_frame_size);
 
 		snd_pcm_hw_params_t* hwparams = nullptr;
 		snd_pcm_sw_params_t* swparams = nullptr;
@@ -460,6 +552,16 @@ namespace Piper
 		} else if ((err = snd_pcm_hw_params(m_handle, hwparams)) < 0) {
 			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaCaptureDevice::configure] Cannot commit hardware parameters"));
 		}
+
+		if ((err = snd_pcm_sw_params_current(m_handle, swparams)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaCaptureDevice::configure] Cannot initialize software parameters"));
+		} else if ((err = snd_pcm_sw_params_set_tstamp_mode(m_handle, swparams, SND_PCM_TSTAMP_ENABLE)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaCaptureDevice::configure] Cannot configure software parameters on timestamp mode"));
+		} else if ((err = snd_pcm_sw_params_set_tstamp_type(m_handle, swparams, SND_PCM_TSTAMP_TYPE_MONOTONIC)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaCaptureDevice::configure] Cannot configure software parameters on timestamp type"));
+		} else if ((err = snd_pcm_sw_params(m_handle, swparams)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaCaptureDevice::configure] Cannot commit software parameters"));
+		}
 	}
 
 	void AlsaCaptureDevice::start()
@@ -536,14 +638,448 @@ namespace Piper
 				std::memcpy(start, m_partial_data + (m_frame_size - m_partial_size), copied);
 				destination.consume(copied);
 				m_partial_size -= copied;
-			} else if (pending >= m_frame_size) {
+				start += copied;
+				pending -= copied;
+
+				if (m_partial_size > 0) {
+					return;
+				}
+			}
+
+			if (pending >= m_frame_size) {
 				std::size_t copied = m_frame_size * do_read_alsa_pcm(m_handle, start, pending / m_frame_size, timeout);
 				destination.consume(copied);
-			} else if (do_read_alsa_pcm(m_handle, m_partial_data, 1, timeout) == 1) {
-				std::memcpy(start, m_partial_data, pending);
-				destination.consume(pending);
-				m_partial_size = m_frame_size - pending;
+				start += copied;
+				pending -= copied;
+
+				if (copied == 0) {
+					return;
+				}
 			}
+
+			if (pending > 0 && pending < m_frame_size) {
+				if (do_read_alsa_pcm(m_handle, m_partial_data, 1, timeout) == 1) {
+					std::memcpy(start, m_partial_data, pending);
+					destination.consume(pending);
+					m_partial_size = m_frame_size - pending;
+				}
+			}
+		}
+	}
+
+	Timestamp AlsaCaptureDevice::timestamp()
+	{
+		snd_pcm_status_t* status = nullptr;
+		snd_htimestamp_t stamp;
+
+		snd_pcm_status_alloca(&status);
+
+		if (snd_pcm_status(m_handle, status) < 0) {
+			return 0;
+		}
+
+		snd_pcm_status_get_htstamp(status, &stamp);
+
+		if (stamp.tv_sec == 0 && stamp.tv_nsec == 0) {
+			return 0;
+		} else {
+			return stamp.tv_sec * 1000000000 + stamp.tv_nsec;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Mmap based ALSA playback device implementation.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	/**
+	 * Return the address of the given frame in the mapped device buffer. The
+	 * helper assumes interleaved access mode where all channels share a single
+	 * area and each frame occupies a contiguous chunk of the area.
+	 */
+	static inline char* area_address(const snd_pcm_channel_area_t* areas, snd_pcm_uframes_t offset)
+	{
+		return static_cast<char*>(areas[0].addr) + areas[0].first / 8 + offset * (areas[0].step / 8);
+	}
+
+	static snd_pcm_uframes_t do_write_alsa_pcm_mmap(snd_pcm_t* pcm, const char* buffer, snd_pcm_uframes_t count, std::size_t frame_size, int timeout)
+	{
+		int waited = snd_pcm_wait(pcm, timeout);
+
+		if (waited == 0) {
+			return 0;
+		} else if (waited == -EINTR) {
+			return 0;
+		} else if (waited == -EPIPE) {
+			EXC_START(EXC_ALSA(-waited), DevicePlaybackException("[Piper::do_write_alsa_pcm_mmap] Cannot write to device due to buffer underrun"));
+		} else if (waited == -ESTRPIPE) {
+			EXC_START(EXC_ALSA(-waited), DevicePlaybackException("[Piper::do_write_alsa_pcm_mmap] Cannot write to device due to suspension"));
+		} else if (waited < 0) {
+			EXC_START(EXC_ALSA(-waited), DeviceUnusableException("[Piper::do_write_alsa_pcm_mmap] Cannot write to device"));
+		}
+
+		snd_pcm_sframes_t available = snd_pcm_avail_update(pcm);
+
+		if (available == 0) {
+			return 0;
+		} else if (available == -EPIPE) {
+			EXC_START(EXC_ALSA(static_cast<int>(-available)), DevicePlaybackException("[Piper::do_write_alsa_pcm_mmap] Cannot write to device due to buffer underrun"));
+		} else if (available == -ESTRPIPE) {
+			EXC_START(EXC_ALSA(static_cast<int>(-available)), DevicePlaybackException("[Piper::do_write_alsa_pcm_mmap] Cannot write to device due to suspension"));
+		} else if (available < 0) {
+			EXC_START(EXC_ALSA(static_cast<int>(-available)), DeviceUnusableException("[Piper::do_write_alsa_pcm_mmap] Cannot write to device"));
+		}
+
+		const snd_pcm_channel_area_t* areas = nullptr;
+		snd_pcm_uframes_t offset = 0;
+		snd_pcm_uframes_t frames = std::min(count, static_cast<snd_pcm_uframes_t>(available));
+		int err = snd_pcm_mmap_begin(pcm, &areas, &offset, &frames);
+
+		if (err == -EPIPE) {
+			EXC_START(EXC_ALSA(-err), DevicePlaybackException("[Piper::do_write_alsa_pcm_mmap] Cannot write to device due to buffer underrun"));
+		} else if (err < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::do_write_alsa_pcm_mmap] Cannot write to device"));
+		}
+
+		std::memcpy(area_address(areas, offset), buffer, frames * frame_size);
+
+		snd_pcm_sframes_t committed = snd_pcm_mmap_commit(pcm, offset, frames);
+
+		if (committed >= 0) {
+			return static_cast<snd_pcm_uframes_t>(committed);
+		} else if (committed == -EPIPE) {
+			EXC_START(EXC_ALSA(static_cast<int>(-committed)), DevicePlaybackException("[Piper::do_write_alsa_pcm_mmap] Cannot write to device due to buffer underrun"));
+		} else if (committed == -ESTRPIPE) {
+			EXC_START(EXC_ALSA(static_cast<int>(-committed)), DevicePlaybackException("[Piper::do_write_alsa_pcm_mmap] Cannot write to device due to suspension"));
+		} else {
+			EXC_START(EXC_ALSA(static_cast<int>(-committed)), DeviceUnusableException("[Piper::do_write_alsa_pcm_mmap] Cannot write to device"));
+		}
+	}
+
+	AlsaMmapPlaybackDevice::AlsaMmapPlaybackDevice(const char* name)
+	{
+		int err = 0;
+
+		if ((err = snd_pcm_open(&m_handle, name, SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::AlsaMmapPlaybackDevice] Cannot open device due to incorrect name"));
+		} else if ((err = snd_pcm_nonblock(m_handle, 2)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::AlsaMmapPlaybackDevice] Cannot switch device to non-blocking mode"));
+		}
+
+		m_frame_size = 0;
+	}
+
+	AlsaMmapPlaybackDevice::~AlsaMmapPlaybackDevice()
+	{
+		snd_pcm_close(m_handle);
+	}
+
+	void AlsaMmapPlaybackDevice::configure(const Pipe& pipe, unsigned int prebuffer)
+	{
+		m_frame_size = pipe.frame_size();
+
+		snd_pcm_hw_params_t* hwparams = nullptr;
+		snd_pcm_sw_params_t* swparams = nullptr;
+		snd_pcm_uframes_t pipe_period_size = pipe.period_size() / m_frame_size;
+		snd_pcm_uframes_t device_period_size = pipe_period_size;
+		snd_pcm_uframes_t device_buffer_size = std::min(pipe_period_size * prebuffer, 2 * pipe_period_size);
+		int dir, err;
+
+		snd_pcm_hw_params_alloca(&hwparams);
+		snd_pcm_sw_params_alloca(&swparams);
+
+		if ((err = snd_pcm_hw_params_any(m_handle, hwparams)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::configure] Cannot initialize hardware parameters"));
+		} else if ((err = snd_pcm_hw_params_set_rate_resample(m_handle, hwparams, 0)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::configure] Cannot configure hardware parameters on resampling"));
+		} else if ((err = snd_pcm_hw_params_set_access(m_handle, hwparams, SND_PCM_ACCESS_MMAP_INTERLEAVED)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::configure] Cannot configure hardware parameters on access mode"));
+		} else if ((err = snd_pcm_hw_params_set_format(m_handle, hwparams, pipe.format_code_alsa())) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::configure] Cannot configure hardware parameters on format"));
+		} else if ((err = snd_pcm_hw_params_set_channels(m_handle, hwparams, pipe.channels())) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::configure] Cannot configure hardware parameters on channels"));
+		} else if ((err = snd_pcm_hw_params_set_rate(m_handle, hwparams, pipe.rate(), 0)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::configure] Cannot configure hardware parameters on rate"));
+		} else if ((err = snd_pcm_hw_params_set_period_size_max(m_handle, hwparams, &device_period_size, &dir)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::configure] Cannot configure hardware parameters on period size"));
+		} else if ((err = snd_pcm_hw_params_set_buffer_size_min(m_handle, hwparams, &device_buffer_size)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::configure] Cannot configure hardware parameters on buffer size"));
+		} else if ((err = snd_pcm_hw_params(m_handle, hwparams)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::configure] Cannot commit hardware parameters"));
+		}
+
+		if ((err = snd_pcm_sw_params_current(m_handle, swparams)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::configure] Cannot initialize software parameters"));
+		} else if ((err = snd_pcm_sw_params_set_start_threshold(m_handle, swparams, device_period_size * 4)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::configure] Cannot configure software parameters on start threshold"));
+		} else if ((err = snd_pcm_sw_params_set_avail_min(m_handle, swparams, 1)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::configure] Cannot configure software parameters on minimum available space"));
+		} else if ((err = snd_pcm_sw_params(m_handle, swparams)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::configure] Cannot commit software parameters"));
+		}
+	}
+
+	void AlsaMmapPlaybackDevice::start()
+	{
+		int err = snd_pcm_prepare(m_handle);
+
+		if (err == -EBADFD) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::start] Cannot prepare device due to corruption"));
+		} else if (err == -ENOTTY) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::start] Cannot prepare device due to disconnection"));
+		} else if (err == -ENODEV) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::start] Cannot prepare device due to disconnection"));
+		} else if (err < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::start] Cannot prepare device"));
+		}
+	}
+
+	void AlsaMmapPlaybackDevice::stop()
+	{
+		int err = snd_pcm_drop(m_handle);
+
+		if (err == -EBADFD) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::stop] Cannot stop device due to corruption"));
+		} else if (err == -ENOTTY) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::stop] Cannot stop device due to disconnection"));
+		} else if (err == -ENODEV) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::stop] Cannot stop device due to disconnection"));
+		} else if (err < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapPlaybackDevice::stop] Cannot stop device"));
+		}
+	}
+
+	void AlsaMmapPlaybackDevice::write(const Buffer buffer)
+	{
+		Source source(buffer);
+
+		while (source.remainder() > 0) {
+			try_write(source, -1);
+		}
+	}
+
+	void AlsaMmapPlaybackDevice::try_write(Source& source)
+	{
+		try_write(source, -1);
+	}
+
+	void AlsaMmapPlaybackDevice::try_write(Source& source, int timeout)
+	{
+		if (source.remainder() % m_frame_size != 0) {
+			EXC_START(std::invalid_argument("[Piper::AlsaMmapPlaybackDevice::try_write] Cannot write to device due to partial frame in source"));
+		} else if (source.remainder() > 0) {
+			Buffer buffer = source.data();
+			source.consume(m_frame_size * do_write_alsa_pcm_mmap(m_handle, buffer.start(), buffer.size() / m_frame_size, m_frame_size, timeout));
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Mmap based ALSA capture device implementation.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	static snd_pcm_uframes_t do_read_alsa_pcm_mmap(snd_pcm_t* pcm, char* buffer, snd_pcm_uframes_t count, std::size_t frame_size, int timeout)
+	{
+		int waited = snd_pcm_wait(pcm, timeout);
+
+		if (waited == 0) {
+			return 0;
+		} else if (waited == -EINTR) {
+			return 0;
+		} else if (waited == -EPIPE) {
+			EXC_START(EXC_ALSA(-waited), DeviceCaptureException("[Piper::do_read_alsa_pcm_mmap] Cannot read from device due to buffer overrun"));
+		} else if (waited == -ESTRPIPE) {
+			EXC_START(EXC_ALSA(-waited), DeviceCaptureException("[Piper::do_read_alsa_pcm_mmap] Cannot read from device due to suspension"));
+		} else if (waited < 0) {
+			EXC_START(EXC_ALSA(-waited), DeviceUnusableException("[Piper::do_read_alsa_pcm_mmap] Cannot read from device"));
+		}
+
+		snd_pcm_sframes_t available = snd_pcm_avail_update(pcm);
+
+		if (available == 0) {
+			return 0;
+		} else if (available == -EPIPE) {
+			EXC_START(EXC_ALSA(static_cast<int>(-available)), DeviceCaptureException("[Piper::do_read_alsa_pcm_mmap] Cannot read from device due to buffer overrun"));
+		} else if (available == -ESTRPIPE) {
+			EXC_START(EXC_ALSA(static_cast<int>(-available)), DeviceCaptureException("[Piper::do_read_alsa_pcm_mmap] Cannot read from device due to suspension"));
+		} else if (available < 0) {
+			EXC_START(EXC_ALSA(static_cast<int>(-available)), DeviceUnusableException("[Piper::do_read_alsa_pcm_mmap] Cannot read from device"));
+		}
+
+		const snd_pcm_channel_area_t* areas = nullptr;
+		snd_pcm_uframes_t offset = 0;
+		snd_pcm_uframes_t frames = std::min(count, static_cast<snd_pcm_uframes_t>(available));
+		int err = snd_pcm_mmap_begin(pcm, &areas, &offset, &frames);
+
+		if (err == -EPIPE) {
+			EXC_START(EXC_ALSA(-err), DeviceCaptureException("[Piper::do_read_alsa_pcm_mmap] Cannot read from device due to buffer overrun"));
+		} else if (err < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::do_read_alsa_pcm_mmap] Cannot read from device"));
+		}
+
+		std::memcpy(buffer, area_address(areas, offset), frames * frame_size);
+
+		snd_pcm_sframes_t committed = snd_pcm_mmap_commit(pcm, offset, frames);
+
+		if (committed >= 0) {
+			return static_cast<snd_pcm_uframes_t>(committed);
+		} else if (committed == -EPIPE) {
+			EXC_START(EXC_ALSA(static_cast<int>(-committed)), DeviceCaptureException("[Piper::do_read_alsa_pcm_mmap] Cannot read from device due to buffer overrun"));
+		} else if (committed == -ESTRPIPE) {
+			EXC_START(EXC_ALSA(static_cast<int>(-committed)), DeviceCaptureException("[Piper::do_read_alsa_pcm_mmap] Cannot read from device due to suspension"));
+		} else {
+			EXC_START(EXC_ALSA(static_cast<int>(-committed)), DeviceUnusableException("[Piper::do_read_alsa_pcm_mmap] Cannot read from device"));
+		}
+	}
+
+	AlsaMmapCaptureDevice::AlsaMmapCaptureDevice(const char* name)
+	{
+		int err = 0;
+
+		if ((err = snd_pcm_open(&m_handle, name, SND_PCM_STREAM_CAPTURE, SND_PCM_NONBLOCK)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::AlsaMmapCaptureDevice] Cannot open device"));
+		} else if ((err = snd_pcm_nonblock(m_handle, 2)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::AlsaMmapCaptureDevice] Cannot switch device to non-blocking mode"));
+		}
+
+		m_frame_size = 0;
+	}
+
+	AlsaMmapCaptureDevice::~AlsaMmapCaptureDevice()
+	{
+		snd_pcm_close(m_handle);
+	}
+
+	void AlsaMmapCaptureDevice::configure(const Pipe& pipe)
+	{
+		m_frame_size = pipe.frame_size();
+
+		snd_pcm_hw_params_t* hwparams = nullptr;
+		snd_pcm_sw_params_t* swparams = nullptr;
+		snd_pcm_uframes_t pipe_period_size = pipe.period_size() / m_frame_size;
+		snd_pcm_uframes_t device_period_size = pipe_period_size;
+		snd_pcm_uframes_t device_buffer_size = 2 * pipe_period_size;
+		int dir, err;
+
+		snd_pcm_hw_params_alloca(&hwparams);
+		snd_pcm_sw_params_alloca(&swparams);
+
+		if ((err = snd_pcm_hw_params_any(m_handle, hwparams)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::configure] Cannot initialize hardware parameters"));
+		} else if ((err = snd_pcm_hw_params_set_rate_resample(m_handle, hwparams, 0)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::configure] Cannot configure hardware parameters on resampling"));
+		} else if ((err = snd_pcm_hw_params_set_access(m_handle, hwparams, SND_PCM_ACCESS_MMAP_INTERLEAVED)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::configure] Cannot configure hardware parameters on access mode"));
+		} else if ((err = snd_pcm_hw_params_set_format(m_handle, hwparams, pipe.format_code_alsa())) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::configure] Cannot configure hardware parameters on format"));
+		} else if ((err = snd_pcm_hw_params_set_channels(m_handle, hwparams, pipe.channels())) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::configure] Cannot configure hardware parameters on channels"));
+		} else if ((err = snd_pcm_hw_params_set_rate(m_handle, hwparams, pipe.rate(), 0)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::configure] Cannot configure hardware parameters on rate"));
+		} else if ((err = snd_pcm_hw_params_set_period_size_max(m_handle, hwparams, &device_period_size, &dir)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::configure] Cannot configure hardware parameters on period size"));
+		} else if ((err = snd_pcm_hw_params_set_buffer_size_min(m_handle, hwparams, &device_buffer_size)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::configure] Cannot configure hardware parameters on buffer size"));
+		} else if ((err = snd_pcm_hw_params(m_handle, hwparams)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::configure] Cannot commit hardware parameters"));
+		}
+
+		if ((err = snd_pcm_sw_params_current(m_handle, swparams)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::configure] Cannot initialize software parameters"));
+		} else if ((err = snd_pcm_sw_params_set_tstamp_mode(m_handle, swparams, SND_PCM_TSTAMP_ENABLE)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::configure] Cannot configure software parameters on timestamp mode"));
+		} else if ((err = snd_pcm_sw_params_set_tstamp_type(m_handle, swparams, SND_PCM_TSTAMP_TYPE_MONOTONIC)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::configure] Cannot configure software parameters on timestamp type"));
+		} else if ((err = snd_pcm_sw_params(m_handle, swparams)) < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::configure] Cannot commit software parameters"));
+		}
+	}
+
+	void AlsaMmapCaptureDevice::start()
+	{
+		int err1 = snd_pcm_prepare(m_handle);
+
+		if (err1 == -EBADFD) {
+			EXC_START(EXC_ALSA(-err1), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::start] Cannot prepare device due to corruption"));
+		} else if (err1 == -ENOTTY) {
+			EXC_START(EXC_ALSA(-err1), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::start] Cannot prepare device due to disconnection"));
+		} else if (err1 == -ENODEV) {
+			EXC_START(EXC_ALSA(-err1), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::start] Cannot prepare device due to disconnection"));
+		} else if (err1 < 0) {
+			EXC_START(EXC_ALSA(-err1), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::start] Cannot prepare device"));
+		}
+
+		int err2 = snd_pcm_start(m_handle);
+
+		if (err2 == -EBADFD) {
+			EXC_START(EXC_ALSA(-err2), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::start] Cannot start device due to corruption"));
+		} else if (err2 == -ENOTTY) {
+			EXC_START(EXC_ALSA(-err2), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::start] Cannot start device due to disconnection"));
+		} else if (err2 == -ENODEV) {
+			EXC_START(EXC_ALSA(-err2), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::start] Cannot start device due to disconnection"));
+		} else if (err2 < 0) {
+			EXC_START(EXC_ALSA(-err2), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::start] Cannot start device"));
+		}
+	}
+
+	void AlsaMmapCaptureDevice::stop()
+	{
+		int err = snd_pcm_drop(m_handle);
+
+		if (err == -EBADFD) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::stop] Cannot stop device due to corruption"));
+		} else if (err == -ENOTTY) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::stop] Cannot stop device due to disconnection"));
+		} else if (err == -ENODEV) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::stop] Cannot stop device due to disconnection"));
+		} else if (err < 0) {
+			EXC_START(EXC_ALSA(-err), DeviceUnusableException("[Piper::AlsaMmapCaptureDevice::stop] Cannot stop device"));
+		}
+	}
+
+	void AlsaMmapCaptureDevice::read(Buffer buffer)
+	{
+		Destination destination(buffer);
+
+		while (destination.remainder() > 0) {
+			try_read(destination, -1);
+		}
+	}
+
+	void AlsaMmapCaptureDevice::try_read(Destination& destination)
+	{
+		try_read(destination, -1);
+	}
+
+	void AlsaMmapCaptureDevice::try_read(Destination& destination, int timeout)
+	{
+		if (destination.remainder() % m_frame_size != 0) {
+			EXC_START(std::invalid_argument("[Piper::AlsaMmapCaptureDevice::try_read] Cannot read from device due to partial frame in destination"));
+		} else if (destination.remainder() > 0) {
+			Buffer buffer = destination.data();
+			destination.consume(m_frame_size * do_read_alsa_pcm_mmap(m_handle, buffer.start(), buffer.size() / m_frame_size, m_frame_size, timeout));
+		}
+	}
+
+	Timestamp AlsaMmapCaptureDevice::timestamp()
+	{
+		snd_pcm_status_t* status = nullptr;
+		snd_htimestamp_t stamp;
+
+		snd_pcm_status_alloca(&status);
+
+		if (snd_pcm_status(m_handle, status) < 0) {
+			return 0;
+		}
+
+		snd_pcm_status_get_htstamp(status, &stamp);
+
+		if (stamp.tv_sec == 0 && stamp.tv_nsec == 0) {
+			return 0;
+		} else {
+			return stamp.tv_sec * 1000000000 + stamp.tv_nsec;
 		}
 	}
 
@@ -1,12 +1,16 @@
 
 
 #include <exception>
+#include <memory>
 #include <stdexcept>
 
 #include <alsa/asoundlib.h>
 
+#include "arena.hpp"
 #include "buffer.hpp"
+#include "timestamp.hpp"
 #include "file.hpp"
+#include "uring.hpp"
 #include "pipe.hpp"
 
 
@@ -110,6 +114,17 @@ namespace Piper
 			 */
 			virtual void try_write(Source& source, int timeout) = 0;
 
+			/**
+			 * Write audio data from multiple possibly non-contiguous buffers to
+			 * the playback device. Like the try_write variant, the method will
+			 * wait until the device is ready, write some data to the device and
+			 * then return. The default implementation writes the segments one
+			 * after another via the single buffer variant and stops at the
+			 * first segment that makes no progress; devices capable of vectored
+			 * transfers may override it to move every segment in one operation.
+			 */
+			virtual void try_write(GatherSource& source);
+
 	};
 
 	/**
@@ -200,6 +215,27 @@ namespace Piper
 			 */
 			virtual void try_read(Destination& destination, int timeout) = 0;
 
+			/**
+			 * Read audio data from the capture device into multiple possibly
+			 * non-contiguous buffers. Like the try_read variant, the method
+			 * will wait until the device is ready, read some data from the
+			 * device and then return. The default implementation fills the
+			 * segments one after another via the single buffer variant and
+			 * stops at the first segment that makes no progress; devices
+			 * capable of vectored transfers may override it to fill every
+			 * segment in one operation.
+			 */
+			virtual void try_read(ScatterDestination& destination);
+
+			/**
+			 * Return the device-side timestamp of the most recently captured
+			 * sample. Devices backed by real hardware may override the method
+			 * to expose driver buffering to feed clients. The default
+			 * implementation returns zero to indicate that the device has no
+			 * clock of its own.
+			 */
+			virtual Timestamp timestamp() { return 0; }
+
 	};
 
 	/**
@@ -240,6 +276,12 @@ namespace Piper
 			 */
 			void try_write(Source& source) override;
 
+			/**
+			 * Write audio data to the standard output. The method moves every
+			 * segment of the source in a single writev(2) call.
+			 */
+			void try_write(GatherSource& source) override;
+
 			/**
 			 * Write audio data to the standard output.
 			 */
@@ -257,6 +299,13 @@ namespace Piper
 			 */
 			File m_file;
 
+			/**
+			 * Ring for submitting write operations to the kernel, or nullptr
+			 * when the kernel does not support io_uring and the classic file
+			 * I/O path should be used instead.
+			 */
+			std::unique_ptr<Ring> m_ring;
+
 	};
 
 	/**
@@ -297,6 +346,12 @@ namespace Piper
 			 */
 			void try_read(Destination& destination) override;
 
+			/**
+			 * Read audio data from standard input. The method fills every
+			 * segment of the destination in a single readv(2) call.
+			 */
+			void try_read(ScatterDestination& destination) override;
+
 			/**
 			 * Read audio data from standard input.
 			 */
@@ -314,12 +369,22 @@ namespace Piper
 			 */
 			File m_file;
 
+			/**
+			 * Ring for submitting read operations to the kernel, or nullptr
+			 * when the kernel does not support io_uring and the classic file
+			 * I/O path should be used instead.
+			 */
+			std::unique_ptr<Ring> m_ring;
+
 	};
 
 	/**
 	 * This class implements a playback device that sends audio data to ALSA
 	 * PCM device. The class supports partial frames for all write member
-	 * functions.
+	 * functions. Whole frames flow directly from the caller buffer into the
+	 * device call; only the fractional frame at either end of a transfer
+	 * passes through a single frame carry cache, so a misaligned transfer
+	 * costs a few bytes of copying instead of staging whole periods.
 	 */
 	class AlsaPlaybackDevice : public PlaybackDevice
 	{
@@ -359,6 +424,11 @@ namespace Piper
 			 */
 			void write(const Buffer buffer) override;
 
+			/**
+			 * Pull in the gather variant of try_write from the base class.
+			 */
+			using PlaybackDevice::try_write;
+
 			/**
 			 * Write audio data to the ALSA PCM buffer.
 			 */
@@ -396,6 +466,13 @@ namespace Piper
 			 */
 			std::size_t m_partial_size;
 
+			/**
+			 * Arena backing the partial frame cache. It retains its storage
+			 * across reconfiguration, so repeated format renegotiation incurs
+			 * no heap churn.
+			 */
+			Support::Arena m_arena;
+
 			/**
 			 * Pointer to the partial frame cache. Its size is specified by the
 			 * `m_frame_size` member variable. Unwritten data can be found at the
@@ -409,7 +486,10 @@ namespace Piper
 	/**
 	 * This class implements a capture device that reads audio data from ALSA
 	 * PCM device. The class supports partial frames for all read member
-	 * functions.
+	 * functions. Whole frames flow directly from the device call into the
+	 * caller buffer; only the fractional frame at either end of a transfer
+	 * passes through a single frame carry cache, so a misaligned transfer
+	 * costs a few bytes of copying instead of staging whole periods.
 	 */
 	class AlsaCaptureDevice : public CaptureDevice
 	{
@@ -445,6 +525,11 @@ namespace Piper
 			 */
 			void read(Buffer buffer) override;
 
+			/**
+			 * Pull in the scatter variant of try_read from the base class.
+			 */
+			using CaptureDevice::try_read;
+
 			/**
 			 * Read audio data from standard input.
 			 */
@@ -455,6 +540,15 @@ namespace Piper
 			 */
 			void try_read(Destination& destination, int timeout) override;
 
+			/**
+			 * Return the device-side timestamp of the most recently captured
+			 * sample as reported by the ALSA PCM status. The timestamp shares
+			 * the monotonic clock with the rest of the process, so it can be
+			 * compared against pipeline timestamps directly. The method
+			 * returns zero when the driver reports no timestamp.
+			 */
+			Timestamp timestamp() override;
+
 			AlsaCaptureDevice(const AlsaCaptureDevice& device) = delete;
 			AlsaCaptureDevice(AlsaCaptureDevice&& device) = delete;
 			AlsaCaptureDevice& operator=(const AlsaCaptureDevice& device) = delete;
@@ -482,6 +576,13 @@ namespace Piper
 			 */
 			std::size_t m_partial_size;
 
+			/**
+			 * Arena backing the partial frame cache. It retains its storage
+			 * across reconfiguration, so repeated format renegotiation incurs
+			 * no heap churn.
+			 */
+			Support::Arena m_arena;
+
 			/**
 			 * Pointer to the partial frame cache. Its size is specified by the
 			 * `m_frame_size` member variable. Unread data can be found at the end
@@ -492,6 +593,182 @@ namespace Piper
 
 	};
 
+	/**
+	 * This class implements a playback device that writes audio data directly
+	 * into the mapped buffer of an ALSA PCM device. Unlike the normal ALSA
+	 * playback device, audio data is copied from the input buffer straight
+	 * into the device buffer without passing through any intermediate staging
+	 * buffer, saving one copy per period.
+	 *
+	 * Note that the class does NOT support partial frames; buffers passed to
+	 * the write member functions must contain whole frames only.
+	 */
+	class AlsaMmapPlaybackDevice : public PlaybackDevice
+	{
+		public:
+
+			/**
+			 * Construct a new mmap based alsa playback device.
+			 */
+			AlsaMmapPlaybackDevice(const char* name);
+
+			/**
+			 * Destruct the mmap based alsa playback device.
+			 */
+			~AlsaMmapPlaybackDevice();
+
+			/**
+			 * Configure the playback device for the pipe. It will configure the ALSA
+			 * PCM for mmap access according to the pipe and calculate the frame size
+			 * for unit conversion.
+			 */
+			void configure(const Pipe& pipe, unsigned int prebuffer) override;
+
+			/**
+			 * Prepare the ALSA PCM so that its buffer can be written into. Playback
+			 * will start automatically once enough audio data is accumulated.
+			 */
+			void start() override;
+
+			/**
+			 * Stop the playback in the ALSA PCM and drop all remaining audio data in
+			 * the buffer.
+			 */
+			void stop() override;
+
+			/**
+			 * Write audio data to the mapped ALSA PCM buffer.
+			 */
+			void write(const Buffer buffer) override;
+
+			/**
+			 * Pull in the gather variant of try_write from the base class.
+			 */
+			using PlaybackDevice::try_write;
+
+			/**
+			 * Write audio data to the mapped ALSA PCM buffer.
+			 */
+			void try_write(Source& source) override;
+
+			/**
+			 * Write audio data to the mapped ALSA PCM buffer.
+			 */
+			void try_write(Source& source, int timeout) override;
+
+			AlsaMmapPlaybackDevice(const AlsaMmapPlaybackDevice& device) = delete;
+			AlsaMmapPlaybackDevice(AlsaMmapPlaybackDevice&& device) = delete;
+			AlsaMmapPlaybackDevice& operator=(const AlsaMmapPlaybackDevice& device) = delete;
+			AlsaMmapPlaybackDevice& operator=(AlsaMmapPlaybackDevice&& device) = delete;
+
+		private:
+
+			/**
+			 * Handle of the ALSA PCM device.
+			 */
+			snd_pcm_t* m_handle;
+
+			/**
+			 * Frame size of the audio data accepted by the device. It is used for
+			 * size conversion in write member functions as well as locating frames
+			 * in the mapped device buffer.
+			 */
+			std::size_t m_frame_size;
+
+	};
+
+	/**
+	 * This class implements a capture device that reads audio data directly
+	 * from the mapped buffer of an ALSA PCM device. Unlike the normal ALSA
+	 * capture device, audio data is copied from the device buffer straight
+	 * into the output buffer without passing through any intermediate staging
+	 * buffer, saving one copy per period.
+	 *
+	 * Note that the class does NOT support partial frames; buffers passed to
+	 * the read member functions must contain whole frames only.
+	 */
+	class AlsaMmapCaptureDevice : public CaptureDevice
+	{
+		public:
+
+			/**
+			 * Construct a new mmap based alsa capture device.
+			 */
+			AlsaMmapCaptureDevice(const char* name);
+
+			/**
+			 * Destruct the mmap based alsa capture device.
+			 */
+			~AlsaMmapCaptureDevice();
+
+			/**
+			 * Configure the capture device for the pipe. It will configure the ALSA
+			 * PCM for mmap access according to the pipe and calculate the frame size
+			 * for unit conversion.
+			 */
+			void configure(const Pipe& pipe) override;
+
+			/**
+			 * Prepare and start the ALSA PCM so that its buffer can be read from.
+			 */
+			void start() override;
+
+			/**
+			 * Stop the capture in the ALSA PCM and drop all remaining audio data in
+			 * the buffer.
+			 */
+			void stop() override;
+
+			/**
+			 * Read audio data from the mapped ALSA PCM buffer.
+			 */
+			void read(Buffer buffer) override;
+
+			/**
+			 * Pull in the scatter variant of try_read from the base class.
+			 */
+			using CaptureDevice::try_read;
+
+			/**
+			 * Read audio data from the mapped ALSA PCM buffer.
+			 */
+			void try_read(Destination& destination) override;
+
+			/**
+			 * Read audio data from the mapped ALSA PCM buffer.
+			 */
+			void try_read(Destination& destination, int timeout) override;
+
+			/**
+			 * Return the device-side timestamp of the most recently captured
+			 * sample as reported by the ALSA PCM status. The timestamp shares
+			 * the monotonic clock with the rest of the process, so it can be
+			 * compared against pipeline timestamps directly. The method
+			 * returns zero when the driver reports no timestamp.
+			 */
+			Timestamp timestamp() override;
+
+			AlsaMmapCaptureDevice(const AlsaMmapCaptureDevice& device) = delete;
+			AlsaMmapCaptureDevice(AlsaMmapCaptureDevice&& device) = delete;
+			AlsaMmapCaptureDevice& operator=(const AlsaMmapCaptureDevice& device) = delete;
+			AlsaMmapCaptureDevice& operator=(AlsaMmapCaptureDevice&& device) = delete;
+
+		private:
+
+			/**
+			 * Handle of the ALSA PCM device.
+			 */
+			snd_pcm_t* m_handle;
+
+			/**
+			 * Frame size of the audio data returned by the device. It is used for
+			 * size conversion in read member functions as well as locating frames
+			 * in the mapped device buffer.
+			 */
+			std::size_t m_frame_size;
+
+	};
+
 	/**
 	 * Exception thrown the device cannot be operation upon due to some
 	 * permanent, unrecoverable reason like device removal.
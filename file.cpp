@@ -21,6 +21,7 @@
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include "exception.hpp"
 #include "buffer.hpp"
@@ -258,6 +259,35 @@ namespace Piper
 		destination.consume(read(destination.data()));
 	}
 
+	void File::read(ScatterDestination& destination)
+	{
+		if (m_readable == false) {
+			EXC_START(FileNotReadableException("[Piper::File::read] Cannot read file due to open mode"));
+		} else if (destination.remainder() == 0) {
+			return;
+		}
+
+		struct iovec vector[16];
+		std::size_t count = destination.scatter(vector, 16);
+		ssize_t done = ::readv(m_descriptor, vector, static_cast<int>(count));
+
+		if (done > 0) {
+			destination.consume(static_cast<std::size_t>(done));
+		} else if (done < 0 && errno == EINTR) {
+			return;
+		} else if (done < 0 && errno == EAGAIN) {
+			return;
+		} else if (done < 0 && errno == EWOULDBLOCK) {
+			return;
+		} else if (done == 0) {
+			EXC_START(EndOfFileException("[Piper::File::read] Cannot read past the end of file"));
+		} else if (done < 0 && errno == EBADF) {
+			EXC_START(std::logic_error("[Piper::File::read] Cannot read file due to stale descriptor"));
+		} else {
+			EXC_START(EXC_SYSTEM(errno), FileIOException("[Piper::File::read] Cannot read file due to operating system error"));
+		}
+	}
+
 	void File::readall(Buffer& buffer)
 	{
 		readall(Destination(buffer));
@@ -362,6 +392,44 @@ namespace Piper
 		}
 	}
 
+	void File::try_readall(ScatterDestination& destination, int timeout)
+	{
+		if (m_readable == false) {
+			EXC_START(FileNotReadableException("[Piper::File::try_readall] Cannot read file due to open mode"));
+		} else if (m_blocking && timeout >= 0) {
+			EXC_START(FileMayBlockException("[Piper::File::try_readall] Cannot read file due to possible blocking"));
+		}
+
+		if (destination.remainder() > 0) {
+			if (m_blocking) {
+				read(destination);
+			} else {
+				// If the file is non-blocking, the read method will return immediately,
+				// turning this loop into a busy loop. To avoid this situation, we need
+				// to use poll(2) to yield to the operating system and wait until the
+				// descriptor is readable.
+
+				struct pollfd pollfd;
+				pollfd.fd = m_descriptor;
+				pollfd.events = POLLIN;
+
+				int result = ::poll(&pollfd, 1, timeout);
+
+				if (result > 0 && (pollfd.revents & POLLIN) > 0) {
+					read(destination);
+				} else if (result > 0 && (pollfd.revents & POLLHUP) > 0) {
+					read(destination);
+				} else if (result > 0 && (pollfd.revents & POLLNVAL) > 0) {
+					EXC_START(std::logic_error("[Piper::File::try_readall] Cannot read file due to stale descriptor"));
+				} else if (result > 0 && (pollfd.revents & POLLERR) > 0) {
+					EXC_START(EXC_SYSTEM(errno), FileIOException("[Piper::File::try_readall] Cannot read file due to operating system error"));
+				} else if (result < 0 && errno != EINTR) {
+					EXC_START(EXC_SYSTEM(errno), FileIOException("[Piper::File::try_readall] Cannot read file due to operating system error"));
+				}
+			}
+		}
+	}
+
 	size_t File::write(const Buffer& source)
 	{
 		if (m_writable == false) {
@@ -399,6 +467,35 @@ namespace Piper
 		source.consume(write(source.data()));
 	}
 
+	void File::write(GatherSource& source)
+	{
+		if (m_writable == false) {
+			EXC_START(FileNotWritableException("[Piper::File::write] Cannot write file due to open mode"));
+		} else if (source.remainder() == 0) {
+			return;
+		}
+
+		struct iovec vector[16];
+		std::size_t count = source.gather(vector, 16);
+		ssize_t done = ::writev(m_descriptor, vector, static_cast<int>(count));
+
+		if (done >= 0) {
+			source.consume(static_cast<std::size_t>(done));
+		} else if (errno == EINTR) {
+			return;
+		} else if (errno == EAGAIN) {
+			return;
+		} else if (errno == EWOULDBLOCK) {
+			return;
+		} else if (errno == EPIPE) {
+			EXC_START(EndOfFileException("[Piper::File::write] Cannot write file due to closed receiver side"));
+		} else if (errno == EBADF) {
+			EXC_START(std::logic_error("[Piper::File::write] Cannot write file due to stale descriptor"));
+		} else {
+			EXC_START(EXC_SYSTEM(errno), FileIOException("[Piper::File::write] Cannot write file due to operating system error"));
+		}
+	}
+
 	void File::writeall(const Buffer& buffer)
 	{
 		writeall(Source(buffer));
@@ -498,6 +595,44 @@ namespace Piper
 		}
 	}
 
+	void File::try_writeall(GatherSource& source, int timeout)
+	{
+		if (m_writable == false) {
+			EXC_START(FileNotWritableException("[Piper::File::try_writeall] Cannot write file due to open mode"));
+		} else if (m_blocking && timeout >= 0) {
+			EXC_START(FileMayBlockException("[Piper::File::try_writeall] Cannot write file due to possible blocking"));
+		}
+
+		if (source.remainder() > 0) {
+			if (m_blocking) {
+				write(source);
+			} else {
+				// If the file is non-blocking, the write method will return immediately,
+				// turning this loop into a busy loop. To avoid this situation, we need
+				// to use poll(2) to yield to the operating system and wait until the
+				// descriptor is writable.
+
+				struct pollfd pollfd;
+				pollfd.fd = m_descriptor;
+				pollfd.events = POLLOUT;
+
+				int result = ::poll(&pollfd, 1, timeout);
+
+				if (result > 0 && (pollfd.revents & POLLOUT) > 0) {
+					write(source);
+				} else if (result > 0 && (pollfd.revents & POLLHUP) > 0) {
+					EXC_START(EndOfFileException("[Piper::File::try_writeall] Cannot write file due to closed receiver side"));
+				} else if (result > 0 && (pollfd.revents & POLLNVAL) > 0) {
+					EXC_START(std::logic_error("[Piper::File::try_writeall] Cannot write file due to stale descriptor"));
+				} else if (result > 0 && (pollfd.revents & POLLERR) > 0) {
+					EXC_START(EXC_SYSTEM(errno), FileIOException("[Piper::File::try_writeall] Cannot write file due to operating system error"));
+				} else if (result < 0 && errno != EINTR) {
+					EXC_START(EXC_SYSTEM(errno), FileIOException("[Piper::File::try_writeall] Cannot write file due to operating system error"));
+				}
+			}
+		}
+	}
+
 	void File::truncate(std::size_t length)
 	{
 		if (m_writable == false) {
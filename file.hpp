@@ -173,6 +173,24 @@ namespace Piper
 			 */
 			void read(Destination&& destination);
 
+			/**
+			 * Read data from the file into the scatter destination. The method
+			 * will read data from the file ONCE with a single readv(2) call
+			 * spanning every unused segment of the destination, save the result
+			 * and update the destination counter accordingly. The method
+			 * implements slightly different behavior when the descriptor is
+			 * under different mode.
+			 *
+			 * When the descriptor is under blocking mode, the method will block
+			 * until enough data is read or when the process receives a POSIX
+			 * signal.
+			 *
+			 * On the other hand, when the descriptor is under non-blocking mode,
+			 * the method will save any available data and return immediately. In
+			 * this case the method may return without reading anything.
+			 */
+			void read(ScatterDestination& destination);
+
 			/**
 			 * Read data from the file into the buffer. The method will REPEATEDLY
 			 * read data from the file and save the result into the buffer. The
@@ -263,6 +281,23 @@ namespace Piper
 			 */
 			void try_readall(Destination&& destination, int timeout);
 
+			/**
+			 * Read data from the file into the scatter destination. The method
+			 * will attempt to read data from the file with a single readv(2)
+			 * call spanning every unused segment of the destination, save the
+			 * result and update the destination counter accordingly. The method
+			 * will return when:
+			 *
+			 * 1. Some data is read into the destination; or
+			 * 2. The process receives POSIX signal; or
+			 * 3. The specified timeout has elapsed.
+			 *
+ 			 * Note that the timeout accepts 2 special values. The timeout of 0
+			 * means no waiting. The timeout of -1 indicates that timeout is
+			 * not observed.
+			 */
+			void try_readall(ScatterDestination& destination, int timeout);
+
 			/**
 			 * Write data from the buffer to the file. The method will write
 			 * the descriptor ONCE with data from the buffer and return the
@@ -284,6 +319,14 @@ namespace Piper
 			 */
 			void write(Source&& source);
 
+			/**
+			 * Write data from the gather source to the file. The method will
+			 * write the descriptor ONCE with a single writev(2) call spanning
+			 * every unread segment of the source and update the source counter
+			 * accordingly.
+			 */
+			void write(GatherSource& source);
+
 			/**
 			 * Write data from the buffer to the file. The method will REPEATEDLY
 			 * write the descriptor with data from the buffer. The method will only
@@ -363,6 +406,22 @@ namespace Piper
 			 */
 			void try_writeall(Source&& source, int timeout);
 
+			/**
+			 * Write data from the gather source to the file. The method will
+			 * attempt to write the descriptor with a single writev(2) call
+			 * spanning every unread segment of the source and update the source
+			 * counter accordingly. The method will return when:
+			 *
+			 * 1. Some data is written from the source; or
+			 * 2. The process receives POSIX signal; or
+			 * 3. The specified timeout has elapsed.
+			 *
+ 			 * Note that the timeout accepts 2 special values. The timeout of 0
+			 * means no waiting. The timeout of -1 indicates that timeout is
+			 * not observed.
+			 */
+			void try_writeall(GatherSource& source, int timeout);
+
 			/**
 			 * Truncate the descriptor to the given length.
 			 */
@@ -4,7 +4,12 @@
 #define _XOPEN_SOURCE
 #define _BSD_SOURCE
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
 
+
+#include <algorithm>
 #include <atomic>
 #include <cctype>
 #include <climits>
@@ -13,19 +18,31 @@
 #include <cstdlib>
 #include <cstring>
 #include <exception>
+#include <memory>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
+#include <errno.h>
+#include <sched.h>
 #include <signal.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
 #include <alsa/asoundlib.h>
 
 #include "exception.hpp"
 #include "timestamp.hpp"
+#include "pool.hpp"
 #include "buffer.hpp"
 #include "pipe.hpp"
 #include "tokenbucket.hpp"
 #include "device.hpp"
 #include "operation.hpp"
+#include "route.hpp"
+#include "mix.hpp"
+#include "bridge.hpp"
+#include "record.hpp"
 #include "statistics.hpp"
 #include "config.h"
 
@@ -35,6 +52,7 @@ using Support::Statistics::make_filter;
 using Support::Statistics::make_magnitude;
 using Support::Statistics::make_divergence;
 using Support::Statistics::make_delta;
+using Support::Statistics::make_quantile;
 
 
 /**
@@ -93,11 +111,17 @@ class Callback : public Piper::Callback
 		 */
 		explicit Callback() :
 			m_tracking(false),
+			m_watching(false),
+			m_preemptions(-1),
 			m_operation(0),
 			m_write_period_value(make_delta(make_filter(make_average()))),
 			m_write_period_jitter(make_delta(make_filter(make_divergence(make_average())))),
+			m_capture_delay_value(make_filter(make_average())),
+			m_capture_delay_jitter(make_filter(make_delta(make_magnitude(make_average())))),
 			m_transfer_delay_value(make_filter(make_average())),
-			m_transfer_delay_jitter(make_filter(make_delta(make_magnitude(make_average()))))
+			m_transfer_delay_jitter(make_filter(make_delta(make_magnitude(make_average())))),
+			m_transfer_delay_p99(make_filter(make_quantile(0.99))),
+			m_transfer_delay_p999(make_filter(make_quantile(0.999)))
 		{
 			// do nothing
 		}
@@ -107,11 +131,17 @@ class Callback : public Piper::Callback
 		 */
 		explicit Callback(bool tracking) :
 			m_tracking(tracking),
+			m_watching(false),
+			m_preemptions(-1),
 			m_operation(0),
 			m_write_period_value(make_delta(make_filter(make_average()))),
 			m_write_period_jitter(make_delta(make_filter(make_divergence(make_average())))),
+			m_capture_delay_value(make_filter(make_average())),
+			m_capture_delay_jitter(make_filter(make_delta(make_magnitude(make_average())))),
 			m_transfer_delay_value(make_filter(make_average())),
-			m_transfer_delay_jitter(make_filter(make_delta(make_magnitude(make_average()))))
+			m_transfer_delay_jitter(make_filter(make_delta(make_magnitude(make_average())))),
+			m_transfer_delay_p99(make_filter(make_quantile(0.99))),
+			m_transfer_delay_p999(make_filter(make_quantile(0.999)))
 		{
 			// do nothing
 		}
@@ -151,8 +181,12 @@ class Callback : public Piper::Callback
 				m_first = true;
 				m_write_period_value = make_delta(make_filter(make_average(count), 0.0, 10000.0));
 				m_write_period_jitter = make_delta(make_filter(make_divergence(make_average(count), m_period), 0.0, 10000.0));
+				m_capture_delay_value = make_filter(make_average(count), 0.0, 10000.0);
+				m_capture_delay_jitter = make_filter(make_delta(make_magnitude(make_average(count))), 0.0, 10000.0);
 				m_transfer_delay_value = make_filter(make_average(count), 0.0, 10000.0);
 				m_transfer_delay_jitter = make_filter(make_delta(make_magnitude(make_average(count))), 0.0, 10000.0);
+				m_transfer_delay_p99 = make_filter(make_quantile(0.99), 0.0, 10000.0);
+				m_transfer_delay_p999 = make_filter(make_quantile(0.999), 0.0, 10000.0);
 			}
 		}
 
@@ -170,9 +204,17 @@ class Callback : public Piper::Callback
 				m_write_period_value.consume(current);
 				m_write_period_jitter.consume(current);
 
+				if (m_operation == DRAIN && preamble.capture != 0) {
+					const double capture = convert_timestamp(preamble.capture);
+					m_capture_delay_value.consume(current - capture);
+					m_capture_delay_jitter.consume(current - capture);
+				}
+
 				if (m_operation == DRAIN) {
 					m_transfer_delay_value.consume(now - current);
 					m_transfer_delay_jitter.consume(now - current);
+					m_transfer_delay_p99.consume(now - current);
+					m_transfer_delay_p999.consume(now - current);
 				}
 
 				if (m_operation == FEED && first) {
@@ -183,28 +225,60 @@ class Callback : public Piper::Callback
 					std::fprintf(stderr, "INFO: Statistics     |       Reference        Measured       Variation\n");
 					std::fprintf(stderr, "INFO: ---------------+-------------------------------------------------\n");
 					std::fprintf(stderr, "INFO: Write Period   |%16.3f%16.3f%16.3f\n", m_period, m_write_period_value.value(), m_write_period_jitter.value());
+					std::fprintf(stderr, "INFO: Capture Delay  |%16.3f%16.3f%16.3f\n", m_period, m_capture_delay_value.value(), m_capture_delay_jitter.value());
 					std::fprintf(stderr, "INFO: Transfer Delay |%16.3f%16.3f%16.3f\n", m_period, m_transfer_delay_value.value(), m_transfer_delay_jitter.value());
+					std::fprintf(stderr, "INFO: Delay P99      |%16.3f%16.3f%16s\n", m_period, m_transfer_delay_p99.value(), "");
+					std::fprintf(stderr, "INFO: Delay P999     |%16.3f%16.3f%16s\n", m_period, m_transfer_delay_p999.value(), "");
 				} else if (m_operation == FEED) {
 					std::fprintf(stderr, "\x1b[3A\x1b[2K\x1b[1G");
 					std::fprintf(stderr, "INFO: Statistics     |       Reference        Measured       Variation\n");
 					std::fprintf(stderr, "INFO: ---------------+-------------------------------------------------\n");
 					std::fprintf(stderr, "INFO: Write Period   |%16.3f%16.3f%16.3f\n", m_period, m_write_period_value.value(), m_write_period_jitter.value());
 				} else if (m_operation == DRAIN) {
-					std::fprintf(stderr, "\x1b[4A\x1b[2K\x1b[1G");
+					std::fprintf(stderr, "\x1b[7A\x1b[2K\x1b[1G");
 					std::fprintf(stderr, "INFO: Statistics     |       Reference        Measured       Variation\n");
 					std::fprintf(stderr, "INFO: ---------------+-------------------------------------------------\n");
 					std::fprintf(stderr, "INFO: Write Period   |%16.3f%16.3f%16.3f\n", m_period, m_write_period_value.value(), m_write_period_jitter.value());
+					std::fprintf(stderr, "INFO: Capture Delay  |%16.3f%16.3f%16.3f\n", m_period, m_capture_delay_value.value(), m_capture_delay_jitter.value());
 					std::fprintf(stderr, "INFO: Transfer Delay |%16.3f%16.3f%16.3f\n", m_period, m_transfer_delay_value.value(), m_transfer_delay_jitter.value());
+					std::fprintf(stderr, "INFO: Delay P99      |%16.3f%16.3f%16s\n", m_period, m_transfer_delay_p99.value(), "");
+					std::fprintf(stderr, "INFO: Delay P999     |%16.3f%16.3f%16s\n", m_period, m_transfer_delay_p999.value(), "");
 				}
 			}
 		}
 
+		/**
+		 * Start watching for involuntary preemptions of the process. Once
+		 * enabled, each tick compares the involuntary context switch count
+		 * from getrusage(2) against the last observed value and reports any
+		 * increase, so scheduling interference under realtime operation
+		 * becomes visible.
+		 */
+		void watch_preemptions()
+		{
+			m_watching = true;
+			m_preemptions = -1;
+		}
+
 		/**
 		 * Handle ticks during the feed/drain operation by checking the reload/quit
 		 * flags and throwing appropriate exception.
 		 */
 		void on_tick() override
 		{
+			if (m_watching) {
+				struct rusage usage;
+
+				if (::getrusage(RUSAGE_THREAD, &usage) == 0) {
+					if (m_preemptions < 0) {
+						m_preemptions = usage.ru_nivcsw;
+					} else if (usage.ru_nivcsw > m_preemptions) {
+						std::fprintf(stderr, "WARN: Involuntary preemption detected (%ld total)\n", usage.ru_nivcsw);
+						m_preemptions = usage.ru_nivcsw;
+					}
+				}
+			}
+
 			if (quit == true) {
 				reload = false;
 				quit = false;
@@ -235,13 +309,19 @@ class Callback : public Piper::Callback
 		}
 
 		bool m_tracking;
+		bool m_watching;
+		long m_preemptions;
 		int m_operation;
 		double m_period;
 		bool m_first;
 		decltype(make_delta(make_filter(make_average()))) m_write_period_value;
 		decltype(make_delta(make_filter(make_divergence(make_average())))) m_write_period_jitter;
+		decltype(make_filter(make_average())) m_capture_delay_value;
+		decltype(make_filter(make_delta(make_magnitude(make_average())))) m_capture_delay_jitter;
 		decltype(make_filter(make_average())) m_transfer_delay_value;
 		decltype(make_filter(make_delta(make_magnitude(make_average())))) m_transfer_delay_jitter;
+		decltype(make_filter(make_quantile())) m_transfer_delay_p99;
+		decltype(make_filter(make_quantile())) m_transfer_delay_p999;
 
 };
 
@@ -315,10 +395,54 @@ void print_exception(const std::exception& ex, bool initial = true)
 }
 
 
+/**
+ * Configure the process for realtime operation. A positive priority
+ * switches the process to the SCHED_FIFO scheduling class at that
+ * priority and locks current and future process memory via mlockall(2),
+ * so the pipe mapping and device buffers created afterwards are faulted
+ * in and pinned before the transfer loop starts. A non-negative cpu pins
+ * the process to that processor. Returns whether the configuration
+ * succeeds; failures are reported to stderr.
+ */
+bool configure_realtime(unsigned int priority, int cpu)
+{
+	if (cpu >= 0) {
+		cpu_set_t cpuset;
+
+		CPU_ZERO(&cpuset);
+		CPU_SET(static_cast<std::size_t>(cpu), &cpuset);
+
+		if (::sched_setaffinity(0, sizeof(cpuset), &cpuset) < 0) {
+			std::fprintf(stderr, "ERROR: Cannot pin process to cpu %d: %s\n", cpu, strerror(errno));
+			return false;
+		}
+	}
+
+	if (priority > 0) {
+		struct sched_param param;
+
+		std::memset(&param, 0, sizeof(param));
+		param.sched_priority = static_cast<int>(priority);
+
+		if (::sched_setscheduler(0, SCHED_FIFO, &param) < 0) {
+			std::fprintf(stderr, "ERROR: Cannot enable realtime scheduling: %s\n", strerror(errno));
+			return false;
+		}
+
+		if (::mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+			std::fprintf(stderr, "ERROR: Cannot lock process memory: %s\n", strerror(errno));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
 /**
  * Feed pipe from the given device.
  */
-template<class Device, class ... Parameters> int do_feed(bool statistics, const char* path, Parameters ... args)
+template<class Device, class ... Parameters> int do_feed(bool statistics, unsigned int priority, int cpu, const char* path, Parameters ... args)
 {
 	try {
 		::signal(SIGTERM, trigger_quit);
@@ -326,8 +450,16 @@ template<class Device, class ... Parameters> int do_feed(bool statistics, const
 		::signal(SIGQUIT, trigger_quit);
 		::signal(SIGHUP, trigger_reload);
 
+		if (configure_realtime(priority, cpu) == false) {
+			return 2;
+		}
+
 		while (true) {
 			Callback callback(statistics);
+
+			if (priority > 0) {
+				callback.watch_preemptions();
+			}
 			Piper::FeedOperation operation(callback);
 			Piper::Pipe pipe(path);
 			Device input(args...);
@@ -364,7 +496,7 @@ template<class Device, class ... Parameters> int do_feed(bool statistics, const
 /**
  * Drain pipe to the given device.
  */
-template<class Device, class ... Parameters> int do_drain(bool statistics, const char* path, Parameters ... args)
+template<class Device, class ... Parameters> int do_drain(bool statistics, unsigned int priority, int cpu, const char* path, Parameters ... args)
 {
 	try {
 		::signal(SIGTERM, trigger_quit);
@@ -372,8 +504,16 @@ template<class Device, class ... Parameters> int do_drain(bool statistics, const
 		::signal(SIGQUIT, trigger_quit);
 		::signal(SIGHUP, trigger_reload);
 
+		if (configure_realtime(priority, cpu) == false) {
+			return 2;
+		}
+
 		while (true) {
 			Callback callback(statistics);
+
+			if (priority > 0) {
+				callback.watch_preemptions();
+			}
 			Piper::DrainOperation operation(callback);
 			Piper::Pipe pipe(path);
 			Device output(args...);
@@ -407,6 +547,178 @@ template<class Device, class ... Parameters> int do_drain(bool statistics, const
 }
 
 
+/**
+ * Send pipe content to the given remote host.
+ */
+int do_send(bool statistics, unsigned int priority, int cpu, const char* path, const char* host, const char* service)
+{
+	try {
+		::signal(SIGTERM, trigger_quit);
+		::signal(SIGINT, trigger_quit);
+		::signal(SIGQUIT, trigger_quit);
+		::signal(SIGHUP, trigger_reload);
+
+		if (configure_realtime(priority, cpu) == false) {
+			return 2;
+		}
+
+		while (true) {
+			Callback callback(statistics);
+
+			if (priority > 0) {
+				callback.watch_preemptions();
+			}
+
+			Piper::SendOperation operation(callback);
+			Piper::Pipe pipe(path);
+
+			try {
+				operation.execute(pipe, host, service);
+			} catch (ReloadException& ex) {
+				std::fprintf(stderr, "INFO: Reload program due to signal\n");
+			}
+		}
+	} catch (QuitException& ex) {
+		return 0;
+	} catch (std::exception& ex) {
+		std::fprintf(stderr, "ERROR: Cannot send pipe due to exception\n");
+		print_exception(ex);
+		return 3;
+	} catch (...) {
+		std::fprintf(stderr, "ERROR: Cannot send pipe\n\n");
+		return 3;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Feed pipe from the given remote host.
+ */
+int do_recv(bool statistics, unsigned int priority, int cpu, const char* path, const char* service)
+{
+	try {
+		::signal(SIGTERM, trigger_quit);
+		::signal(SIGINT, trigger_quit);
+		::signal(SIGQUIT, trigger_quit);
+		::signal(SIGHUP, trigger_reload);
+
+		if (configure_realtime(priority, cpu) == false) {
+			return 2;
+		}
+
+		while (true) {
+			Callback callback(statistics);
+
+			if (priority > 0) {
+				callback.watch_preemptions();
+			}
+
+			Piper::ReceiveOperation operation(callback);
+			Piper::Pipe pipe(path);
+
+			try {
+				operation.execute(pipe, service);
+			} catch (ReloadException& ex) {
+				std::fprintf(stderr, "INFO: Reload program due to signal\n");
+			}
+		}
+	} catch (QuitException& ex) {
+		return 0;
+	} catch (std::exception& ex) {
+		std::fprintf(stderr, "ERROR: Cannot receive pipe due to exception\n");
+		print_exception(ex);
+		return 3;
+	} catch (...) {
+		std::fprintf(stderr, "ERROR: Cannot receive pipe\n\n");
+		return 3;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Record pipe content into the given recording file.
+ */
+int do_record(bool statistics, unsigned int priority, int cpu, const char* path, const char* file)
+{
+	try {
+		::signal(SIGTERM, trigger_quit);
+		::signal(SIGINT, trigger_quit);
+		::signal(SIGQUIT, trigger_quit);
+		::signal(SIGHUP, trigger_quit);
+
+		if (configure_realtime(priority, cpu) == false) {
+			return 2;
+		}
+
+		Callback callback(statistics);
+
+		if (priority > 0) {
+			callback.watch_preemptions();
+		}
+
+		Piper::RecordOperation operation(callback);
+		Piper::Pipe pipe(path);
+
+		operation.execute(pipe, file);
+	} catch (QuitException& ex) {
+		return 0;
+	} catch (std::exception& ex) {
+		std::fprintf(stderr, "ERROR: Cannot record pipe due to exception\n");
+		print_exception(ex);
+		return 3;
+	} catch (...) {
+		std::fprintf(stderr, "ERROR: Cannot record pipe\n\n");
+		return 3;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Replay the given recording file into the pipe.
+ */
+int do_replay(bool statistics, unsigned int priority, int cpu, const char* path, const char* file)
+{
+	try {
+		::signal(SIGTERM, trigger_quit);
+		::signal(SIGINT, trigger_quit);
+		::signal(SIGQUIT, trigger_quit);
+		::signal(SIGHUP, trigger_quit);
+
+		if (configure_realtime(priority, cpu) == false) {
+			return 2;
+		}
+
+		Callback callback(statistics);
+
+		if (priority > 0) {
+			callback.watch_preemptions();
+		}
+
+		Piper::ReplayOperation operation(callback);
+		Piper::Pipe pipe(path);
+
+		operation.execute(pipe, file);
+	} catch (QuitException& ex) {
+		return 0;
+	} catch (std::exception& ex) {
+		std::fprintf(stderr, "ERROR: Cannot replay recording due to exception\n");
+		print_exception(ex);
+		return 3;
+	} catch (...) {
+		std::fprintf(stderr, "ERROR: Cannot replay recording\n\n");
+		return 3;
+	}
+
+	return 0;
+}
+
+
 /**
  * Create a new pipe.
  */
@@ -420,6 +732,22 @@ int create(int argc, char **argv)
 		unsigned int readable = parse_number(argv[7]);
 		unsigned int writable = parse_number(argv[8]);
 		unsigned int separation = parse_number(argv[9]);
+		std::uint32_t options = 0;
+
+		for (int i = 10; i < argc; i++) {
+			if (std::strcmp(argv[i], "prefault") == 0) {
+				options |= Piper::Backer::OPTION_PREFAULT;
+			} else if (std::strcmp(argv[i], "lock") == 0) {
+				options |= Piper::Backer::OPTION_LOCK;
+			} else if (std::strcmp(argv[i], "hugepage") == 0) {
+				options |= Piper::Backer::OPTION_HUGEPAGE;
+			} else if (std::strcmp(argv[i], "stream") == 0) {
+				options |= Piper::Backer::OPTION_STREAM;
+			} else {
+				std::fprintf(stderr, "ERROR: Option %s is not recognized\n\n", argv[i]);
+				return 2;
+			}
+		}
 
 		if (snd_pcm_format_value(format) == SND_PCM_FORMAT_UNKNOWN) {
 			std::fprintf(stderr, "ERROR: Format %s is not recognized\n\n", format);
@@ -439,7 +767,7 @@ int create(int argc, char **argv)
 		}
 
 		try {
-			Piper::Pipe pipe(argv[2], format, channels, rate, period, readable, writable, separation, 0640);
+			Piper::Pipe pipe(argv[2], format, channels, rate, period, readable, writable, separation, 0640, options);
 			return 0;
 		} catch (std::exception& ex) {
 			std::fprintf(stderr, "ERROR: Cannot create pipe due to exception\n");
@@ -448,7 +776,7 @@ int create(int argc, char **argv)
 		}
 	} else {
 		std::fprintf(stderr, "ERROR: Missing arguments\n");
-		std::fprintf(stderr, "Usage: %s create <path> <format> <channels> <rate> <period> <buffer> <capacity>\n\n", argv[0]);
+		std::fprintf(stderr, "Usage: %s create <path> <format> <channels> <rate> <period> <readable> <writable> <separation> [prefault] [lock] [hugepage] [stream]\n\n", argv[0]);
 		return 1;
 	}
 }
@@ -481,6 +809,7 @@ int info(int argc, char **argv)
 			std::fprintf(stderr, "  Transport details\n");
 			std::fprintf(stderr, " ------------------------------------------------------\n");
 			std::fprintf(stderr, "  Slot Count: %u\n", backer.slot_count());
+			std::fprintf(stderr, "  Mapping Options:%s%s%s%s%s\n", (backer.options() == 0 ? " none" : ""), ((backer.options() & Piper::Backer::OPTION_PREFAULT) != 0 ? " prefault" : ""), ((backer.options() & Piper::Backer::OPTION_LOCK) != 0 ? " lock" : ""), ((backer.options() & Piper::Backer::OPTION_HUGEPAGE) != 0 ? " hugepage" : ""), ((backer.options() & Piper::Backer::OPTION_STREAM) != 0 ? " stream" : ""));
 			std::fprintf(stderr, "  Component Count: %lu\n", backer.component_count());
 			std::fprintf(stderr, "  Metadata Size: %zu\n", backer.metadata_size());
 			std::fprintf(stderr, "  Component Sizes: ");
@@ -511,6 +840,18 @@ int info(int argc, char **argv)
 
 			std::fprintf(stderr, "\n");
 			std::fprintf(stderr, "  Total Size: %zu\n", backer.total_size());
+			std::fprintf(stderr, "\n");
+			std::fprintf(stderr, "  Reader details\n");
+			std::fprintf(stderr, " ------------------------------------------------------\n");
+
+			for (unsigned int i = 0; i < transport.cursor_count(); i++) {
+				Piper::Transport::Position position = transport.cursor(i);
+
+				if (position != Piper::Backer::CURSOR_FREE) {
+					std::fprintf(stderr, "  Reader %u: position %lu, lag %lu periods\n", i, position, transport.middle() - position);
+				}
+			}
+
 			std::fprintf(stderr, "\n");
 
 			return 0;
@@ -535,10 +876,16 @@ int feed(int argc, char **argv)
 	char* path = nullptr;
 	char* device = nullptr;
 	bool statistics = false;
+	unsigned int priority = 0;
+	int cpu = -1;
 
 	for (int i = 2; i < argc; i++) {
 		if (std::strcmp(argv[i], "-s") == 0) {
 			statistics = true;
+		} else if (std::strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+			priority = parse_number(argv[++i]);
+		} else if (std::strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+			cpu = static_cast<int>(parse_number(argv[++i]));
 		} else if (path == nullptr) {
 			path = argv[i];
 		} else if (device == nullptr) {
@@ -548,20 +895,24 @@ int feed(int argc, char **argv)
 
 	if (path == nullptr) {
 		std::fprintf(stderr, "ERROR: Missing arguments\n");
-		std::fprintf(stderr, "Usage: %s feed [-s] <path> [<device>]\n\n", argv[0]);
+		std::fprintf(stderr, "Usage: %s feed [-s] [-r <priority>] [-c <cpu>] <path> [<device>]\n\n", argv[0]);
 		return 1;
 	}
 
 	if (device == nullptr) {
-		return do_feed<Piper::StdinCaptureDevice>(statistics, path);
+		return do_feed<Piper::StdinCaptureDevice>(statistics, priority, cpu, path);
 	} else if (strcmp(device, "-") == 0) {
-		return do_feed<Piper::StdinCaptureDevice>(statistics, path);
+		return do_feed<Piper::StdinCaptureDevice>(statistics, priority, cpu, path);
 	} else if (strcmp(device, "stdin") == 0) {
-		return do_feed<Piper::StdinCaptureDevice>(statistics, path);
+		return do_feed<Piper::StdinCaptureDevice>(statistics, priority, cpu, path);
 	} else if (strcmp(device, "alsa") == 0) {
-		return do_feed<Piper::AlsaCaptureDevice>(statistics, path, "default");
+		return do_feed<Piper::AlsaCaptureDevice>(statistics, priority, cpu, path, "default");
 	} else if (strncmp(device, "alsa:", 5) == 0) {
-		return do_feed<Piper::AlsaCaptureDevice>(statistics, path, device + 5);
+		return do_feed<Piper::AlsaCaptureDevice>(statistics, priority, cpu, path, device + 5);
+	} else if (strcmp(device, "alsa-mmap") == 0) {
+		return do_feed<Piper::AlsaMmapCaptureDevice>(statistics, priority, cpu, path, "default");
+	} else if (strncmp(device, "alsa-mmap:", 10) == 0) {
+		return do_feed<Piper::AlsaMmapCaptureDevice>(statistics, priority, cpu, path, device + 10);
 	} else {
 		std::fprintf(stderr, "ERROR: Unknown capture device %s\n", device);
 		return 1;
@@ -577,10 +928,16 @@ int drain(int argc, char **argv)
 	char* path = nullptr;
 	char* device = nullptr;
 	bool statistics = false;
+	unsigned int priority = 0;
+	int cpu = -1;
 
 	for (int i = 2; i < argc; i++) {
 		if (std::strcmp(argv[i], "-s") == 0) {
 			statistics = true;
+		} else if (std::strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+			priority = parse_number(argv[++i]);
+		} else if (std::strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+			cpu = static_cast<int>(parse_number(argv[++i]));
 		} else if (path == nullptr) {
 			path = argv[i];
 		} else if (device == nullptr) {
@@ -590,20 +947,24 @@ int drain(int argc, char **argv)
 
 	if (path == nullptr) {
 		std::fprintf(stderr, "ERROR: Missing arguments\n");
-		std::fprintf(stderr, "Usage: %s drain [-s] <path> [<device>]\n\n", argv[0]);
+		std::fprintf(stderr, "Usage: %s drain [-s] [-r <priority>] [-c <cpu>] <path> [<device>]\n\n", argv[0]);
 		return 1;
 	}
 
 	if (device == nullptr) {
-		return do_drain<Piper::StdoutPlaybackDevice>(statistics, path);
+		return do_drain<Piper::StdoutPlaybackDevice>(statistics, priority, cpu, path);
 	} else if (strcmp(device, "-") == 0) {
-		return do_drain<Piper::StdoutPlaybackDevice>(statistics, path);
+		return do_drain<Piper::StdoutPlaybackDevice>(statistics, priority, cpu, path);
 	} else if (strcmp(device, "stdin") == 0) {
-		return do_drain<Piper::StdoutPlaybackDevice>(statistics, path);
+		return do_drain<Piper::StdoutPlaybackDevice>(statistics, priority, cpu, path);
 	} else if (strcmp(device, "alsa") == 0) {
-		return do_drain<Piper::AlsaPlaybackDevice>(statistics, path, "default");
+		return do_drain<Piper::AlsaPlaybackDevice>(statistics, priority, cpu, path, "default");
 	} else if (strncmp(device, "alsa:", 5) == 0) {
-		return do_drain<Piper::AlsaPlaybackDevice>(statistics, path, device + 5);
+		return do_drain<Piper::AlsaPlaybackDevice>(statistics, priority, cpu, path, device + 5);
+	} else if (strcmp(device, "alsa-mmap") == 0) {
+		return do_drain<Piper::AlsaMmapPlaybackDevice>(statistics, priority, cpu, path, "default");
+	} else if (strncmp(device, "alsa-mmap:", 10) == 0) {
+		return do_drain<Piper::AlsaMmapPlaybackDevice>(statistics, priority, cpu, path, device + 10);
 	} else {
 		std::fprintf(stderr, "ERROR: Unknown playback device %s\n", device);
 		return 1;
@@ -611,6 +972,568 @@ int drain(int argc, char **argv)
 }
 
 
+/**
+ * Record pipe into a recording file.
+ */
+int record(int argc, char **argv)
+{
+	char* path = nullptr;
+	char* file = nullptr;
+	bool statistics = false;
+	unsigned int priority = 0;
+	int cpu = -1;
+
+	for (int i = 2; i < argc; i++) {
+		if (std::strcmp(argv[i], "-s") == 0) {
+			statistics = true;
+		} else if (std::strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+			priority = parse_number(argv[++i]);
+		} else if (std::strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+			cpu = static_cast<int>(parse_number(argv[++i]));
+		} else if (path == nullptr) {
+			path = argv[i];
+		} else if (file == nullptr) {
+			file = argv[i];
+		}
+	}
+
+	if (path == nullptr || file == nullptr) {
+		std::fprintf(stderr, "ERROR: Missing arguments\n");
+		std::fprintf(stderr, "Usage: %s record [-s] [-r <priority>] [-c <cpu>] <path> <file>\n\n", argv[0]);
+		return 1;
+	}
+
+	return do_record(statistics, priority, cpu, path, file);
+}
+
+
+/**
+ * Replay a recording file into a pipe.
+ */
+int replay(int argc, char **argv)
+{
+	char* path = nullptr;
+	char* file = nullptr;
+	bool statistics = false;
+	unsigned int priority = 0;
+	int cpu = -1;
+
+	for (int i = 2; i < argc; i++) {
+		if (std::strcmp(argv[i], "-s") == 0) {
+			statistics = true;
+		} else if (std::strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+			priority = parse_number(argv[++i]);
+		} else if (std::strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+			cpu = static_cast<int>(parse_number(argv[++i]));
+		} else if (path == nullptr) {
+			path = argv[i];
+		} else if (file == nullptr) {
+			file = argv[i];
+		}
+	}
+
+	if (path == nullptr || file == nullptr) {
+		std::fprintf(stderr, "ERROR: Missing arguments\n");
+		std::fprintf(stderr, "Usage: %s replay [-s] [-r <priority>] [-c <cpu>] <path> <file>\n\n", argv[0]);
+		return 1;
+	}
+
+	return do_replay(statistics, priority, cpu, path, file);
+}
+
+
+/**
+ * Send pipe to a remote host.
+ */
+int send(int argc, char **argv)
+{
+	char* path = nullptr;
+	char* host = nullptr;
+	char* service = nullptr;
+	bool statistics = false;
+	unsigned int priority = 0;
+	int cpu = -1;
+
+	for (int i = 2; i < argc; i++) {
+		if (std::strcmp(argv[i], "-s") == 0) {
+			statistics = true;
+		} else if (std::strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+			priority = parse_number(argv[++i]);
+		} else if (std::strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+			cpu = static_cast<int>(parse_number(argv[++i]));
+		} else if (path == nullptr) {
+			path = argv[i];
+		} else if (host == nullptr) {
+			host = argv[i];
+		} else if (service == nullptr) {
+			service = argv[i];
+		}
+	}
+
+	if (path == nullptr || host == nullptr || service == nullptr) {
+		std::fprintf(stderr, "ERROR: Missing arguments\n");
+		std::fprintf(stderr, "Usage: %s send [-s] [-r <priority>] [-c <cpu>] <path> <host> <port>\n\n", argv[0]);
+		return 1;
+	}
+
+	return do_send(statistics, priority, cpu, path, host, service);
+}
+
+
+/**
+ * Receive pipe from a remote host.
+ */
+int recv(int argc, char **argv)
+{
+	char* path = nullptr;
+	char* service = nullptr;
+	bool statistics = false;
+	unsigned int priority = 0;
+	int cpu = -1;
+
+	for (int i = 2; i < argc; i++) {
+		if (std::strcmp(argv[i], "-s") == 0) {
+			statistics = true;
+		} else if (std::strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+			priority = parse_number(argv[++i]);
+		} else if (std::strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+			cpu = static_cast<int>(parse_number(argv[++i]));
+		} else if (path == nullptr) {
+			path = argv[i];
+		} else if (service == nullptr) {
+			service = argv[i];
+		}
+	}
+
+	if (path == nullptr || service == nullptr) {
+		std::fprintf(stderr, "ERROR: Missing arguments\n");
+		std::fprintf(stderr, "Usage: %s recv [-s] [-r <priority>] [-c <cpu>] <path> <port>\n\n", argv[0]);
+		return 1;
+	}
+
+	return do_recv(statistics, priority, cpu, path, service);
+}
+
+
+/**
+ * Create a capture device from the given device name. Returns nullptr
+ * when the name is not recognized.
+ */
+Piper::CaptureDevice* make_capture_device(const char* device)
+{
+	if (std::strcmp(device, "-") == 0) {
+		return new Piper::StdinCaptureDevice();
+	} else if (std::strcmp(device, "stdin") == 0) {
+		return new Piper::StdinCaptureDevice();
+	} else if (std::strcmp(device, "alsa") == 0) {
+		return new Piper::AlsaCaptureDevice("default");
+	} else if (std::strncmp(device, "alsa:", 5) == 0) {
+		return new Piper::AlsaCaptureDevice(device + 5);
+	} else if (std::strcmp(device, "alsa-mmap") == 0) {
+		return new Piper::AlsaMmapCaptureDevice("default");
+	} else if (std::strncmp(device, "alsa-mmap:", 10) == 0) {
+		return new Piper::AlsaMmapCaptureDevice(device + 10);
+	} else {
+		return nullptr;
+	}
+}
+
+
+/**
+ * Create a playback device from the given device name. Returns nullptr
+ * when the name is not recognized.
+ */
+Piper::PlaybackDevice* make_playback_device(const char* device)
+{
+	if (std::strcmp(device, "-") == 0) {
+		return new Piper::StdoutPlaybackDevice();
+	} else if (std::strcmp(device, "stdout") == 0) {
+		return new Piper::StdoutPlaybackDevice();
+	} else if (std::strcmp(device, "alsa") == 0) {
+		return new Piper::AlsaPlaybackDevice("default");
+	} else if (std::strncmp(device, "alsa:", 5) == 0) {
+		return new Piper::AlsaPlaybackDevice(device + 5);
+	} else if (std::strcmp(device, "alsa-mmap") == 0) {
+		return new Piper::AlsaMmapPlaybackDevice("default");
+	} else if (std::strncmp(device, "alsa-mmap:", 10) == 0) {
+		return new Piper::AlsaMmapPlaybackDevice(device + 10);
+	} else {
+		return nullptr;
+	}
+}
+
+
+/**
+ * Route multiple pipes from a single process. Each command line argument
+ * specifies a pairing in the form feed:<path>:<device> or
+ * drain:<path>:<device>, and all pairings are serviced by a single event
+ * loop.
+ */
+int route(int argc, char **argv)
+{
+	if (argc < 3) {
+		std::fprintf(stderr, "ERROR: Missing arguments\n");
+		std::fprintf(stderr, "Usage: %s route [-l <slack>] feed|drain:<path>:<device> ...\n\n", argv[0]);
+		return 1;
+	}
+
+	try {
+		::signal(SIGTERM, trigger_quit);
+		::signal(SIGINT, trigger_quit);
+		::signal(SIGQUIT, trigger_quit);
+
+		Piper::Duration slack = 0;
+		int start = 2;
+
+		if (std::strcmp(argv[2], "-l") == 0 && argc >= 5) {
+			slack = parse_number(argv[3]) * 1000ULL;
+			start = 4;
+		}
+
+		Callback callback(false);
+		Piper::Router router(callback, slack);
+		std::vector<std::unique_ptr<Piper::CaptureDevice>> captures;
+		std::vector<std::unique_ptr<Piper::PlaybackDevice>> playbacks;
+
+		for (int i = start; i < argc; i++) {
+			char* spec = argv[i];
+
+			if (std::strncmp(spec, "feed:", 5) == 0) {
+				char* path = spec + 5;
+				char* separator = std::strchr(path, ':');
+				const char* device = "-";
+
+				if (separator != nullptr) {
+					*separator = 0;
+					device = separator + 1;
+				}
+
+				captures.emplace_back(make_capture_device(device));
+
+				if (captures.back() == nullptr) {
+					std::fprintf(stderr, "ERROR: Unknown capture device %s\n", device);
+					return 2;
+				}
+
+				router.add_feed(path, *captures.back());
+			} else if (std::strncmp(spec, "drain:", 6) == 0) {
+				char* path = spec + 6;
+				char* separator = std::strchr(path, ':');
+				const char* device = "-";
+
+				if (separator != nullptr) {
+					*separator = 0;
+					device = separator + 1;
+				}
+
+				playbacks.emplace_back(make_playback_device(device));
+
+				if (playbacks.back() == nullptr) {
+					std::fprintf(stderr, "ERROR: Unknown playback device %s\n", device);
+					return 2;
+				}
+
+				router.add_drain(path, *playbacks.back());
+			} else {
+				std::fprintf(stderr, "ERROR: Unknown pairing %s\n", spec);
+				std::fprintf(stderr, "Usage: %s route [-l <slack>] feed|drain:<path>:<device> ...\n\n", argv[0]);
+				return 1;
+			}
+		}
+
+		try {
+			router.execute();
+		} catch (QuitException& ex) {
+			return 0;
+		}
+
+		return 0;
+	} catch (std::exception& ex) {
+		std::fprintf(stderr, "ERROR: Cannot route pipes due to exception\n");
+		print_exception(ex);
+		return 3;
+	} catch (...) {
+		std::fprintf(stderr, "ERROR: Cannot route pipes\n\n");
+		return 3;
+	}
+}
+
+
+/**
+ * Mix multiple input pipes into a single output pipe. All input pipes
+ * have to match the output pipe in sample format, channel count,
+ * sampling rate and period size.
+ */
+int mix(int argc, char **argv)
+{
+	if (argc < 4) {
+		std::fprintf(stderr, "ERROR: Missing arguments\n");
+		std::fprintf(stderr, "Usage: %s mix [-w <workers>] <output> <input> [<input> ...]\n\n", argv[0]);
+		return 1;
+	}
+
+	try {
+		::signal(SIGTERM, trigger_quit);
+		::signal(SIGINT, trigger_quit);
+		::signal(SIGQUIT, trigger_quit);
+		::signal(SIGHUP, trigger_reload);
+
+		unsigned int workers = 0;
+		int start = 2;
+
+		if (std::strcmp(argv[2], "-w") == 0 && argc >= 6) {
+			workers = parse_number(argv[3]);
+			start = 4;
+		}
+
+		std::unique_ptr<Support::Pool> pool;
+
+		if (workers > 0) {
+			pool.reset(new Support::Pool(workers));
+		}
+
+		while (true) {
+			Callback callback(false);
+			Piper::MixOperation operation = (pool != nullptr ? Piper::MixOperation(callback, *pool) : Piper::MixOperation(callback));
+			Piper::Pipe output(argv[start]);
+
+			std::vector<std::unique_ptr<Piper::Pipe>> pipes;
+			std::vector<Piper::Pipe*> inputs;
+
+			for (int i = start + 1; i < argc; i++) {
+				pipes.emplace_back(new Piper::Pipe(argv[i]));
+				inputs.push_back(pipes.back().get());
+			}
+
+			try {
+				operation.execute(output, inputs);
+			} catch (ReloadException& ex) {
+				std::fprintf(stderr, "INFO: Reload program due to signal\n");
+			}
+		}
+	} catch (QuitException& ex) {
+		return 0;
+	} catch (std::exception& ex) {
+		std::fprintf(stderr, "ERROR: Cannot mix pipes due to exception\n");
+		print_exception(ex);
+		return 3;
+	} catch (...) {
+		std::fprintf(stderr, "ERROR: Cannot mix pipes\n\n");
+		return 3;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Return the given percentile from the sorted sample vector.
+ */
+double percentile(const std::vector<double>& samples, double fraction)
+{
+	if (samples.empty()) {
+		return 0.0;
+	} else {
+		std::size_t index = static_cast<std::size_t>(fraction * double(samples.size() - 1));
+		return samples[index];
+	}
+}
+
+
+/**
+ * Benchmark a pipe geometry by running an in-process feed and drain over
+ * a temporary pipe file. The feeder stamps each block before flushing it
+ * and the drainer measures the write-to-read delay of every block, so the
+ * report reflects the latency cost of the given geometry without any
+ * device in the loop.
+ */
+int bench(int argc, char **argv)
+{
+	if (argc >= 9) {
+		const char* format = argv[2];
+		Piper::Channel channels = parse_number(argv[3]);
+		Piper::Rate rate = parse_number(argv[4]);
+		Piper::Duration period = parse_number(argv[5]) * 1000000ULL;
+		unsigned int readable = parse_number(argv[6]);
+		unsigned int writable = parse_number(argv[7]);
+		unsigned int separation = parse_number(argv[8]);
+		unsigned int duration = (argc >= 10 ? parse_number(argv[9]) : 10);
+
+		if (snd_pcm_format_value(format) == SND_PCM_FORMAT_UNKNOWN) {
+			std::fprintf(stderr, "ERROR: Format %s is not recognized\n\n", format);
+			return 2;
+		} else if (channels == 0) {
+			std::fprintf(stderr, "ERROR: Channels cannot be zero\n\n");
+			return 2;
+		} else if (rate == 0) {
+			std::fprintf(stderr, "ERROR: Rate cannot be zero\n\n");
+			return 2;
+		} else if (readable <= 1) {
+			std::fprintf(stderr, "ERROR: Readable should be larger than 1\n\n");
+			return 2;
+		} else if (writable <= 1) {
+			std::fprintf(stderr, "ERROR: Writable should be larger than 1\n\n");
+			return 2;
+		} else if (duration == 0) {
+			std::fprintf(stderr, "ERROR: Duration cannot be zero\n\n");
+			return 2;
+		}
+
+		char path[64];
+		std::snprintf(path, sizeof(path), "/tmp/piper-bench-%ld", static_cast<long>(::getpid()));
+
+		try {
+			Piper::Pipe pipe(path, format, channels, rate, period, readable, writable, separation, 0600);
+
+			std::atomic_bool stop(false);
+			std::atomic<std::uint64_t> writes(0);
+
+			std::thread feeder([&pipe, &stop, &writes]() {
+				try {
+					Piper::Inlet inlet(pipe);
+					Piper::Inlet::Position cursor(inlet.start());
+					Piper::TokenBucket bucket(10, 1, pipe.period_time());
+
+					bucket.start();
+
+					while (stop == false) {
+						if (bucket.tokens() == 0) {
+							bucket.try_refill(10);
+						} else {
+							inlet.preamble(cursor).timestamp = Piper::now();
+							inlet.flush();
+							bucket.spend(1);
+							cursor++;
+							writes++;
+						}
+					}
+
+					bucket.stop();
+				} catch (std::exception& ex) {
+					std::fprintf(stderr, "ERROR: Benchmark feeder stopped due to exception\n");
+					print_exception(ex);
+				}
+			});
+
+			Piper::Outlet outlet(pipe);
+			Piper::Outlet::Position cursor(outlet.until());
+			std::vector<double> latencies;
+			std::uint64_t wakeups = 0;
+			std::uint64_t reads = 0;
+			std::uint64_t losses = 0;
+
+			latencies.reserve(duration * 1000000000ULL / period + 16);
+
+			Piper::Timestamp begin = Piper::now();
+			Piper::Timestamp deadline = begin + static_cast<Piper::Timestamp>(duration) * 1000000000L;
+
+			while (Piper::now() < deadline) {
+				if (outlet.until() == cursor) {
+					outlet.watch(10);
+					wakeups++;
+				} else if (outlet.start() <= cursor) {
+					latencies.push_back(double(Piper::now() - outlet.preamble(cursor).timestamp) / 1000000.0);
+					reads++;
+					cursor++;
+				} else {
+					losses++;
+					cursor = outlet.until();
+				}
+			}
+
+			double elapsed = double(Piper::now() - begin) / 1000000000.0;
+
+			stop = true;
+			feeder.join();
+			std::remove(path);
+			std::sort(latencies.begin(), latencies.end());
+
+			std::fprintf(stderr, "\n");
+			std::fprintf(stderr, "  Benchmark results (%.1f seconds)\n", elapsed);
+			std::fprintf(stderr, " ------------------------------------------------------\n");
+			std::fprintf(stderr, "  Blocks Written: %lu\n", writes.load());
+			std::fprintf(stderr, "  Blocks Read: %lu\n", reads);
+			std::fprintf(stderr, "  Blocks Lost: %lu\n", losses);
+			std::fprintf(stderr, "  Throughput: %.1f blocks/s or %.0f bytes/s\n", double(reads) / elapsed, double(reads) * double(pipe.period_size()) / elapsed);
+			std::fprintf(stderr, "  Drain Wakeups: %lu\n", wakeups);
+			std::fprintf(stderr, "  Latency p50: %.3f ms\n", percentile(latencies, 0.50));
+			std::fprintf(stderr, "  Latency p90: %.3f ms\n", percentile(latencies, 0.90));
+			std::fprintf(stderr, "  Latency p99: %.3f ms\n", percentile(latencies, 0.99));
+			std::fprintf(stderr, "  Latency max: %.3f ms\n", percentile(latencies, 1.00));
+			std::fprintf(stderr, "\n");
+
+			return 0;
+		} catch (std::exception& ex) {
+			std::remove(path);
+			std::fprintf(stderr, "ERROR: Cannot benchmark pipe due to exception\n");
+			print_exception(ex);
+			return 3;
+		}
+	} else {
+		std::fprintf(stderr, "ERROR: Missing arguments\n");
+		std::fprintf(stderr, "Usage: %s bench <format> <channels> <rate> <period> <readable> <writable> <separation> [<duration>]\n\n", argv[0]);
+		return 1;
+	}
+}
+
+
+/**
+ * Print live statistics of a pipe. The subcommand attaches to the shared
+ * statistics block of the pipe and prints a snapshot of the counters once
+ * per second until interrupted.
+ */
+int stats(int argc, char **argv)
+{
+	if (argc >= 3) {
+		try {
+			::signal(SIGTERM, trigger_quit);
+			::signal(SIGINT, trigger_quit);
+			::signal(SIGQUIT, trigger_quit);
+
+			Piper::Pipe pipe(argv[2]);
+			Piper::Statistics* statistics = pipe.statistics();
+
+			if (statistics == nullptr) {
+				std::fprintf(stderr, "ERROR: Pipe has no statistics component\n");
+				return 2;
+			}
+
+			while (quit == false) {
+				std::uint64_t writes = statistics->writes.load(std::memory_order_relaxed);
+				std::uint64_t reads = statistics->reads.load(std::memory_order_relaxed);
+				std::uint64_t overruns = statistics->overruns.load(std::memory_order_relaxed);
+
+				std::fprintf(stderr, "\n");
+				std::fprintf(stderr, "  Pipe statistics\n");
+				std::fprintf(stderr, " ------------------------------------------------------\n");
+				std::fprintf(stderr, "  Blocks Written: %lu\n", writes);
+				std::fprintf(stderr, "  Blocks Read: %lu\n", reads);
+				std::fprintf(stderr, "  Fill Level: %lu blocks\n", writes - reads);
+				std::fprintf(stderr, "  Overruns: %lu\n", overruns);
+				std::fprintf(stderr, "  Latency < 1 ms: %lu\n", statistics->latencies[0].load(std::memory_order_relaxed));
+
+				for (std::size_t bucket = 1; bucket < 7; bucket++) {
+					std::fprintf(stderr, "  Latency %d-%d ms: %lu\n", 1 << (bucket - 1), 1 << bucket, statistics->latencies[bucket].load(std::memory_order_relaxed));
+				}
+
+				std::fprintf(stderr, "  Latency >= 64 ms: %lu\n", statistics->latencies[7].load(std::memory_order_relaxed));
+				::sleep(1);
+			}
+
+			return 0;
+		} catch (std::exception& ex) {
+			std::fprintf(stderr, "ERROR: Cannot print pipe statistics due to exception\n");
+			print_exception(ex);
+			return 3;
+		}
+	} else {
+		std::fprintf(stderr, "ERROR: Missing arguments\n");
+		std::fprintf(stderr, "Usage: %s stats <path>\n\n", argv[0]);
+		return 1;
+	}
+}
+
+
 /**
  * Unclog a pipe.
  */
@@ -643,7 +1566,7 @@ int unclog(int argc, char **argv)
 int version([[ gnu::unused ]] int argc, char** argv)
 {
 	std::fprintf(stderr, "Piper version %d.%d.%d\n", PIPER_VERSION_MAJOR, PIPER_VERSION_MINOR, PIPER_VERSION_PATCH);
-	std::fprintf(stderr, "Usage: %s create|info|feed|drain|unclog|version <parameter>...\n\n", argv[0]);
+	std::fprintf(stderr, "Usage: %s create|info|feed|drain|route|mix|send|recv|record|replay|bench|stats|unclog|version <parameter>...\n\n", argv[0]);
 	return 0;
 }
 
@@ -661,16 +1584,32 @@ int main(int argc, char **argv)
 		return feed(argc, argv);
 	} else if (argc >= 2 && std::strcmp(argv[1], "drain") == 0) {
 		return drain(argc, argv);
+	} else if (argc >= 2 && std::strcmp(argv[1], "route") == 0) {
+		return route(argc, argv);
+	} else if (argc >= 2 && std::strcmp(argv[1], "mix") == 0) {
+		return mix(argc, argv);
+	} else if (argc >= 2 && std::strcmp(argv[1], "send") == 0) {
+		return send(argc, argv);
+	} else if (argc >= 2 && std::strcmp(argv[1], "recv") == 0) {
+		return recv(argc, argv);
+	} else if (argc >= 2 && std::strcmp(argv[1], "record") == 0) {
+		return record(argc, argv);
+	} else if (argc >= 2 && std::strcmp(argv[1], "replay") == 0) {
+		return replay(argc, argv);
+	} else if (argc >= 2 && std::strcmp(argv[1], "bench") == 0) {
+		return bench(argc, argv);
+	} else if (argc >= 2 && std::strcmp(argv[1], "stats") == 0) {
+		return stats(argc, argv);
 	} else if (argc >= 2 && std::strcmp(argv[1], "unclog") == 0) {
 		return unclog(argc, argv);
 	} else if (argc >= 2 && std::strcmp(argv[1], "version") == 0) {
 		return version(argc, argv);
 	} else if (argc >= 2) {
 		std::fprintf(stderr, "ERROR: Unknown subcommand %s\n", argv[1]);
-		std::fprintf(stderr, "Usage: %s create|info|feed|drain|unclog|version <parameter>...\n\n", argv[0]);
+		std::fprintf(stderr, "Usage: %s create|info|feed|drain|route|mix|send|recv|record|replay|bench|stats|unclog|version <parameter>...\n\n", argv[0]);
 		return 1;
 	} else {
-		std::fprintf(stderr, "Usage: %s create|info|feed|drain|unclog|version <parameter>...\n\n", argv[0]);
+		std::fprintf(stderr, "Usage: %s create|info|feed|drain|route|mix|send|recv|record|replay|bench|stats|unclog|version <parameter>...\n\n", argv[0]);
 		return 0;
 	}
 }
@@ -0,0 +1,282 @@
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <alsa/asoundlib.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "exception.hpp"
+#include "timestamp.hpp"
+#include "buffer.hpp"
+#include "pipe.hpp"
+#include "tokenbucket.hpp"
+#include "mix.hpp"
+
+
+#define EXC_START(...) Support::Exception::start(__VA_ARGS__, "mix.cpp", __LINE__)
+#define EXC_CHAIN(...) Support::Exception::chain(__VA_ARGS__, "mix.cpp", __LINE__);
+
+
+namespace Piper
+{
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Mixing kernels.
+	//
+	// Each kernel accumulates a whole run of samples into the output in a
+	// single pass. On SSE2 capable targets the bulk of the run is processed
+	// in vector registers and only the tail falls through to the scalar
+	// loop; on other targets the scalar loop handles the whole run.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	static void kernel_mix_s16(char* output, const char* input, std::size_t samples)
+	{
+		const std::int16_t* source = reinterpret_cast<const std::int16_t*>(input);
+		std::int16_t* target = reinterpret_cast<std::int16_t*>(output);
+		std::size_t index = 0;
+
+#if defined(__SSE2__)
+		for (; index + 8 <= samples; index += 8) {
+			__m128i accumulator = _mm_loadu_si128(reinterpret_cast<const __m128i*>(target + index));
+			__m128i addend = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(target + index), _mm_adds_epi16(accumulator, addend));
+		}
+#endif
+
+		for (; index < samples; index++) {
+			std::int32_t sum = std::int32_t(target[index]) + std::int32_t(source[index]);
+			sum = (sum > 32767 ? 32767 : sum);
+			sum = (sum < -32768 ? -32768 : sum);
+			target[index] = static_cast<std::int16_t>(sum);
+		}
+	}
+
+	static void kernel_mix_s32(char* output, const char* input, std::size_t samples)
+	{
+		const std::int32_t* source = reinterpret_cast<const std::int32_t*>(input);
+		std::int32_t* target = reinterpret_cast<std::int32_t*>(output);
+		std::size_t index = 0;
+
+#if defined(__SSE2__)
+		for (; index + 4 <= samples; index += 4) {
+			__m128i accumulator = _mm_loadu_si128(reinterpret_cast<const __m128i*>(target + index));
+			__m128i addend = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index));
+			__m128i sum = _mm_add_epi32(accumulator, addend);
+			__m128i overflow = _mm_srai_epi32(_mm_and_si128(_mm_xor_si128(accumulator, sum), _mm_xor_si128(addend, sum)), 31);
+			__m128i saturated = _mm_xor_si128(_mm_srai_epi32(accumulator, 31), _mm_set1_epi32(0x7fffffff));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(target + index), _mm_or_si128(_mm_and_si128(overflow, saturated), _mm_andnot_si128(overflow, sum)));
+		}
+#endif
+
+		for (; index < samples; index++) {
+			std::int64_t sum = std::int64_t(target[index]) + std::int64_t(source[index]);
+			sum = (sum > 2147483647 ? 2147483647 : sum);
+			sum = (sum < -2147483648 ? -2147483648 : sum);
+			target[index] = static_cast<std::int32_t>(sum);
+		}
+	}
+
+	static void kernel_mix_f32(char* output, const char* input, std::size_t samples)
+	{
+		const float* source = reinterpret_cast<const float*>(input);
+		float* target = reinterpret_cast<float*>(output);
+		std::size_t index = 0;
+
+#if defined(__SSE2__)
+		for (; index + 4 <= samples; index += 4) {
+			__m128 ceiling = _mm_set1_ps(1.0f);
+			__m128 floor = _mm_set1_ps(-1.0f);
+			__m128 sum = _mm_add_ps(_mm_loadu_ps(target + index), _mm_loadu_ps(source + index));
+			_mm_storeu_ps(target + index, _mm_max_ps(floor, _mm_min_ps(ceiling, sum)));
+		}
+#endif
+
+		for (; index < samples; index++) {
+			float sum = target[index] + source[index];
+			sum = (sum > 1.0f ? 1.0f : sum);
+			sum = (sum < -1.0f ? -1.0f : sum);
+			target[index] = sum;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Mixer implementation.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	Mixer::Mixer(snd_pcm_format_t format) :
+		m_format(format),
+		m_sample_size(0),
+		m_kernel(nullptr)
+	{
+		if (format == SND_PCM_FORMAT_S16_LE) {
+			m_sample_size = 2;
+			m_kernel = kernel_mix_s16;
+		} else if (format == SND_PCM_FORMAT_S32_LE) {
+			m_sample_size = 4;
+			m_kernel = kernel_mix_s32;
+		} else if (format == SND_PCM_FORMAT_FLOAT_LE) {
+			m_sample_size = 4;
+			m_kernel = kernel_mix_f32;
+		} else {
+			EXC_START(UnsupportedMixFormatException("[Piper::Mixer::Mixer] Cannot create mixer due to unsupported format"));
+		}
+	}
+
+	void Mixer::mix(Buffer& output, const Buffer& input) const
+	{
+		if (input.size() % m_sample_size != 0) {
+			EXC_START(std::invalid_argument("[Piper::Mixer::mix] Cannot mix buffer due to partial sample in input"));
+		} else if (output.size() < input.size()) {
+			EXC_START(std::invalid_argument("[Piper::Mixer::mix] Cannot mix buffer due to insufficient output space"));
+		} else {
+			m_kernel(output.start(), input.start(), input.size() / m_sample_size);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Mix operation implementation.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	[[ noreturn ]] void MixOperation::execute(Pipe& output, const std::vector<Pipe*>& inputs)
+	{
+		if (inputs.empty()) {
+			EXC_START(std::invalid_argument("[Piper::MixOperation::execute] Cannot execute operation due to missing input pipes"));
+		}
+
+		for (Pipe* input : inputs) {
+			if (input->format_code_alsa() != output.format_code_alsa()) {
+				EXC_START(std::invalid_argument("[Piper::MixOperation::execute] Cannot execute operation due to mismatched input format"));
+			} else if (input->channels() != output.channels()) {
+				EXC_START(std::invalid_argument("[Piper::MixOperation::execute] Cannot execute operation due to mismatched input channels"));
+			} else if (input->rate() != output.rate()) {
+				EXC_START(std::invalid_argument("[Piper::MixOperation::execute] Cannot execute operation due to mismatched input rate"));
+			} else if (input->period_size() != output.period_size()) {
+				EXC_START(std::invalid_argument("[Piper::MixOperation::execute] Cannot execute operation due to mismatched input period"));
+			}
+		}
+
+		Mixer mixer(output.format_code_alsa());
+		Inlet inlet(output);
+		Inlet::Position cursor(inlet.start());
+		TokenBucket bucket(10, 1, output.period_time());
+
+		std::vector<std::unique_ptr<Outlet>> outlets;
+		std::vector<Outlet::Position> positions;
+		std::vector<Statistics*> statistics;
+		std::vector<Buffer> contributors;
+
+		for (Pipe* input : inputs) {
+			outlets.emplace_back(new Outlet(*input));
+			positions.push_back(outlets.back()->until());
+			statistics.push_back(input->statistics());
+		}
+
+		bucket.start(now());
+
+		try {
+			while (true) {
+				if (bucket.tokens() == 0) {
+					bucket.try_refill();
+					m_callback.on_tick();
+				} else {
+					Preamble& preamble(inlet.preamble(cursor));
+					Buffer block(inlet.content(cursor));
+
+					contributors.clear();
+					std::memset(block.start(), 0, block.size());
+
+					for (std::size_t i = 0; i < outlets.size(); i++) {
+						Outlet& outlet(*outlets[i]);
+
+						if (outlet.start() > positions[i]) {
+							if (statistics[i] != nullptr) {
+								statistics[i]->overruns.fetch_add(1, std::memory_order_relaxed);
+							}
+
+							positions[i] = outlet.start();
+							outlet.mark(positions[i]);
+						}
+
+						if (outlet.until() > positions[i]) {
+							const Preamble& source(outlet.preamble(positions[i]));
+
+							if ((source.flags & Preamble::FLAG_SILENCE) == 0) {
+								contributors.push_back(outlet.content(positions[i]));
+							}
+
+							if (statistics[i] != nullptr) {
+								statistics[i]->reads.fetch_add(1, std::memory_order_relaxed);
+								statistics[i]->latencies[latency_bucket(now() - source.timestamp)].fetch_add(1, std::memory_order_relaxed);
+							}
+
+							positions[i] += 1;
+							outlet.mark(positions[i]);
+						}
+					}
+
+					if (m_pool != nullptr && contributors.empty() == false) {
+						const std::size_t unit = mixer.sample_size();
+						const std::size_t samples = block.size() / unit;
+						const std::size_t chunk = (samples + m_pool->workers() - 1) / m_pool->workers();
+						Support::Batch batch(*m_pool);
+
+						for (std::size_t offset = 0; offset < samples; offset += chunk) {
+							const std::size_t count = std::min(chunk, samples - offset);
+							const Buffer target(block.slice(offset * unit, count * unit));
+
+							batch.submit([&mixer, &contributors, target, offset, count, unit]() {
+								Buffer destination(target);
+
+								for (const Buffer& input : contributors) {
+									mixer.mix(destination, input.slice(offset * unit, count * unit));
+								}
+							});
+						}
+
+						batch.wait();
+					} else {
+						for (const Buffer& input : contributors) {
+							mixer.mix(block, input);
+						}
+					}
+
+					preamble.timestamp = now();
+					preamble.flags = (contributors.empty() ? Preamble::FLAG_SILENCE : 0);
+					m_callback.on_transfer(preamble, block);
+					inlet.flush();
+					cursor++;
+					bucket.spend(1);
+					m_callback.on_tick();
+				}
+			}
+		} catch (std::exception& ex) {
+			m_callback.on_end();
+			bucket.stop();
+			throw;
+		} catch (...) {
+			m_callback.on_end();
+			bucket.stop();
+			throw;
+		}
+	}
+
+}
+
+
@@ -0,0 +1,195 @@
+
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <alsa/asoundlib.h>
+
+#include "pool.hpp"
+#include "buffer.hpp"
+#include "pipe.hpp"
+#include "operation.hpp"
+
+
+#ifndef MIX_HPP_
+#define MIX_HPP_
+
+
+namespace Piper
+{
+
+	/**
+	 * Mixer implements a sample mixing stage that combines audio data from
+	 * several pipes into one.
+	 *
+	 * The mixer accumulates the samples of an input buffer into an output
+	 * buffer with saturating addition, so that the sum of several loud
+	 * sources clips at full scale instead of wrapping around. The mixing
+	 * kernels process the whole buffer in one call and use SSE2 vector code
+	 * where the target supports it, falling back to portable scalar code
+	 * elsewhere.
+	 *
+	 * The mixer supports the linear little endian formats S16, S32 and
+	 * FLOAT. Other formats are rejected at construction time.
+	 */
+	class Mixer
+	{
+		public:
+
+			/**
+			 * Construct a new mixer for the given sample format. Throws an
+			 * unsupported mix format exception when mixing of the format is not
+			 * implemented.
+			 */
+			explicit Mixer(snd_pcm_format_t format);
+
+			/**
+			 * Return the sample format of the mixer.
+			 */
+			snd_pcm_format_t format() const noexcept { return m_format; }
+
+			/**
+			 * Return the size of a single sample in bytes.
+			 */
+			std::size_t sample_size() const noexcept { return m_sample_size; }
+
+			/**
+			 * Accumulate every sample in the input buffer into the output buffer
+			 * with saturating addition. Throws an invalid argument exception
+			 * when the input buffer contains a partial sample or when the output
+			 * buffer is smaller than the input buffer.
+			 */
+			void mix(Buffer& output, const Buffer& input) const;
+
+		private:
+
+			/**
+			 * Signature of mixing kernels. A kernel accumulates the given number
+			 * of samples from the input pointer into the output pointer.
+			 */
+			typedef void (*Kernel)(char* output, const char* input, std::size_t samples);
+
+			/**
+			 * Sample format of the mixer.
+			 */
+			snd_pcm_format_t m_format;
+
+			/**
+			 * Size of a single sample in bytes.
+			 */
+			std::size_t m_sample_size;
+
+			/**
+			 * Kernel implementing the mix.
+			 */
+			Kernel m_kernel;
+
+	};
+
+	/**
+	 * Mix operation combines data from several input pipes into an output
+	 * pipe.
+	 *
+	 * Implementation Details
+	 * ======================
+	 *
+	 * The operation creates an inlet to the output pipe and an outlet to
+	 * each input pipe, then writes one mixed block per period of the output
+	 * pipe, paced by a token bucket over the period time. For every output
+	 * block, the block is first cleared to silence and then each input with
+	 * an available block has that block accumulated into it with the mixer;
+	 * an input without available data simply contributes silence for the
+	 * period. An input that falls behind the capacity of its pipe is
+	 * resynchronized to the current write position instead of failing.
+	 * Input blocks tagged with the silence flag are skipped without
+	 * reading their data, and the output block is tagged silent when no
+	 * input contributed any samples to it.
+	 *
+	 * All input pipes have to match the output pipe in sample format,
+	 * channel count, sampling rate and period size, so that blocks can be
+	 * mixed sample by sample without conversion or staging.
+	 *
+	 * The operation can optionally spread the accumulation work over a
+	 * worker pool. The output block is then split into one sample range per
+	 * worker and every contributing input is accumulated into its range by
+	 * a pool task, so the per-period CPU work scales over the cores instead
+	 * of saturating one. The pipe bookkeeping stays in the submitting loop,
+	 * which waits for the whole batch before the block is flushed, so the
+	 * order of blocks in the output pipe is unaffected by the pool.
+	 *
+	 * Throughout the operation, appropriate callback will be invoked to
+	 * report the progress. They can be used to stop the operation by
+	 * throwing exceptions.
+	 */
+	class MixOperation
+	{
+		public:
+
+			/**
+			 * Construct a new mix operation that accumulates inline on the
+			 * executing thread.
+			 */
+			explicit MixOperation(Callback& callback) : m_callback(callback), m_pool(nullptr) {}
+
+			/**
+			 * Construct a new mix operation that spreads the accumulation work
+			 * over the given worker pool. The pool should outlive the
+			 * operation.
+			 */
+			MixOperation(Callback& callback, Support::Pool& pool) : m_callback(callback), m_pool(&pool) {}
+
+			/**
+			 * Get the callback used in the mix operation.
+			 */
+			const Callback& callback() const noexcept { return m_callback; }
+
+			/**
+			 * Execute the mix operation. Note that any exception thrown by the
+			 * callback will stop the operation and it will then be rethrown
+			 * verbatim.
+			 */
+			void execute(Pipe& output, const std::vector<Pipe*>& inputs);
+
+		private:
+
+			/**
+			 * Callback invoked during the operation.
+			 */
+			Callback& m_callback;
+
+			/**
+			 * Optional worker pool for the accumulation work. When it is null,
+			 * the operation accumulates inline on the executing thread.
+			 */
+			Support::Pool* m_pool;
+
+	};
+
+	/**
+	 * Exception thrown for any mixer errors.
+	 */
+	class MixException : public std::runtime_error
+	{
+		public:
+			using std::runtime_error::runtime_error;
+	};
+
+	/**
+	 * Exception thrown when mixing of the requested format is not
+	 * implemented by the mixer.
+	 */
+	class UnsupportedMixFormatException : public MixException
+	{
+		public:
+			using MixException::MixException;
+	};
+
+}
+
+
+#endif
+
+
@@ -1,9 +1,16 @@
 
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
 #include <exception>
 
 #include "exception.hpp"
+#include "arena.hpp"
 #include "buffer.hpp"
+#include "statistics.hpp"
 #include "pipe.hpp"
 #include "device.hpp"
 #include "tokenbucket.hpp"
@@ -27,7 +34,7 @@ namespace Piper
 
 		device.configure(pipe);
 		device.start();
-		bucket.start();
+		bucket.start(now());
 		m_callback.on_begin_feed(pipe, device);
 
 		try {
@@ -36,20 +43,38 @@ namespace Piper
 					bucket.try_refill();
 					m_callback.on_tick();
 				} else {
-					Preamble& preamble(inlet.preamble(cursor));
-					Buffer content(inlet.content(cursor));
-					Destination destination(content);
+					unsigned int tokens = bucket.tokens();
+					unsigned int batch = 1;
+					ScatterDestination destination;
+
+					while (batch < tokens && cursor + batch <= inlet.until()) {
+						batch += 1;
+					}
+
+					for (unsigned int i = 0; i < batch; i++) {
+						destination.append(inlet.content(cursor + i));
+					}
 
 					while (destination.remainder() > 0) {
 						device.try_read(destination);
 						m_callback.on_tick();
 					}
 
-					preamble.timestamp = now();
-					m_callback.on_transfer(preamble, content);
-					inlet.flush();
-					bucket.spend(1);
-					cursor++;
+					const Timestamp capture = device.timestamp();
+
+					for (unsigned int i = 0; i < batch; i++) {
+						Preamble& preamble(inlet.preamble(cursor));
+						Buffer block(inlet.content(cursor));
+
+						preamble.timestamp = now();
+						preamble.capture = capture;
+						preamble.flags = (is_silent(block) ? Preamble::FLAG_SILENCE : 0);
+						m_callback.on_transfer(preamble, block);
+						inlet.flush();
+						cursor++;
+					}
+
+					bucket.spend(batch);
 				}
 			}
 		} catch (std::exception& ex) {
@@ -76,11 +101,23 @@ namespace Piper
 		Outlet outlet(pipe);
 		Outlet::Position cursor(outlet.until());
 		TokenBucket bucket(10, 1, pipe.period_time());
+		Statistics* statistics = pipe.statistics();
+		Support::Arena arena(pipe.period_size());
+		char* silence = arena.allocate(pipe.period_size());
+
+		const Duration period = pipe.period_time();
+		const Duration swing = std::max<Duration>(period / 1024, 1);
+		const Duration step = std::max<Duration>(swing / 8, 1);
+		auto lag = Support::Statistics::make_average(64);
+		double reference = std::nan("1");
+		unsigned int window = 0;
+
+		std::memset(silence, 0, pipe.period_size());
 
 		try {
 			device.configure(pipe, 1);
 			device.start();
-			bucket.start();
+			bucket.start(now());
 			m_callback.on_begin_drain(pipe, device);
 
 			while (true) {
@@ -91,19 +128,71 @@ namespace Piper
 					outlet.watch();
 					m_callback.on_tick();
 				} else if (outlet.start() <= cursor) {
-					const Preamble& preamble(outlet.preamble(cursor));
-					const Buffer content(outlet.content(cursor));
-					Source source(content);
+					unsigned int tokens = bucket.tokens();
+					unsigned int batch = 1;
+					GatherSource source;
+
+					while (batch < tokens && cursor + batch < outlet.until()) {
+						batch += 1;
+					}
+
+					for (unsigned int i = 0; i < batch; i++) {
+						if ((outlet.preamble(cursor + i).flags & Preamble::FLAG_SILENCE) != 0) {
+							source.append(Buffer(silence, pipe.period_size()));
+						} else if (outlet.verify(cursor + i) == false) {
+							if (outlet.start() > cursor + i) {
+								if (statistics != nullptr) {
+									statistics->overruns.fetch_add(1, std::memory_order_relaxed);
+								}
+
+								Support::Exception::start(DrainDataLossException("[Piper::DrainOperation::execute] Cannot continue draining pipe due to cursor underrun"), "operation.cpp", __LINE__);
+							}
+
+							Support::Exception::start(PipeCorruptedException("[Piper::DrainOperation::execute] Cannot deliver block due to checksum mismatch"), "operation.cpp", __LINE__);
+						} else {
+							source.append(outlet.content(cursor + i));
+						}
+					}
 
 					while (source.remainder() > 0) {
 						device.try_write(source);
 						m_callback.on_tick();
 					}
 
-					m_callback.on_transfer(preamble, content);
-					bucket.spend(1);
-					cursor += 1;
+					for (unsigned int i = 0; i < batch; i++) {
+						const Preamble& preamble(outlet.preamble(cursor + i));
+
+						if (statistics != nullptr) {
+							statistics->reads.fetch_add(1, std::memory_order_relaxed);
+							statistics->latencies[latency_bucket(now() - preamble.timestamp)].fetch_add(1, std::memory_order_relaxed);
+						}
+
+						m_callback.on_transfer(preamble, outlet.content(cursor + i));
+					}
+
+					bucket.spend(batch);
+					cursor += batch;
+					outlet.mark(cursor);
+
+					lag.consume(static_cast<double>(outlet.until() - cursor));
+					window += batch;
+
+					if (window >= 256) {
+						window = 0;
+
+						if (std::isnan(reference)) {
+							reference = lag.value();
+						} else if (lag.value() > reference + 0.5) {
+							bucket.adjust(std::max(bucket.timer().period() - step, period - swing));
+						} else if (lag.value() < reference - 0.5) {
+							bucket.adjust(std::min(bucket.timer().period() + step, period + swing));
+						}
+					}
 				} else {
+					if (statistics != nullptr) {
+						statistics->overruns.fetch_add(1, std::memory_order_relaxed);
+					}
+
 					Support::Exception::start(DrainDataLossException("[Piper::DrainOperation::execute] Cannot continue draining pipe due to cursor underrun"), "operation.cpp", __LINE__);
 				}
 			}
@@ -84,9 +84,18 @@ namespace Piper
 	 * The transfer phase runs in a loop and each loop will perform an action
 	 * depending on whether the token bucket is empty. If the token bucket is
 	 * empty, the operation should wait until the bucket is refilled. Otherwise,
-	 * a single period of audio data is copied from the capture device to the
-	 * inlet, the current write position is advanced and a token is deducted from
-	 * the token bucket.
+	 * one period of audio data is copied from the capture device to the inlet
+	 * for each available token, the current write position is advanced and the
+	 * spent tokens are deducted from the token bucket. The staging blocks of
+	 * the whole batch are gathered into a scatter destination, so the periods
+	 * are transferred with a single vectored read even when the blocks are
+	 * not contiguous in the pipe, saving wakeups and device calls. After a
+	 * block is filled, it is scanned for zero samples and its preamble is
+	 * tagged with the silence flag accordingly, so that drain clients can
+	 * skip reading silent blocks. The preamble also records the device-side
+	 * capture timestamp next to the flush timestamp, so drain clients can
+	 * split the end-to-end latency into the device stage and the pipeline
+	 * stage.
 	 *
 	 * The transfer phase can be terminated when any exception is thrown. When
 	 * the transfer finishes, cleanup is done by stopping the capture device
@@ -159,9 +168,34 @@ namespace Piper
 	 * outlet has no readable block after the current read position, the
 	 * operation should wait until a new block arrives to the outlet. If the
 	 * current read position is too far behind, the operation should fail with
-	 * an data loss exception. Otherwise, a single period of audio data is
-	 * copied from the outlet to the playback device, the current read position
-	 * is advanced and a token is deducted from the token bucket.
+	 * an data loss exception. Otherwise, one period of audio data is copied
+	 * from the outlet to the playback device for each available token and
+	 * readable block, the current read position is advanced and the spent
+	 * tokens are deducted from the token bucket. The readable blocks of the
+	 * whole batch are gathered into a gather source, so the periods are
+	 * transferred with a single vectored write even when the blocks are not
+	 * contiguous in the pipe, saving wakeups and device calls. Blocks whose
+	 * preambles carry the silence flag are written from a cached silence
+	 * buffer instead of the pipe, so their block data is never read. Blocks
+	 * whose preambles carry a content checksum are verified before delivery.
+	 * When verification fails, the read position is re-checked against the
+	 * start of the pipe first: a mismatch on a block the writer has lapped
+	 * in the meantime is merely a torn read and is reported through the
+	 * usual data loss path, while a mismatch on a still readable block
+	 * fails the operation with a pipe corrupted exception, so content
+	 * corrupted by a host crash is reported instead of played.
+	 *
+	 * The transfer pace is additionally servoed to the feeder of the pipe.
+	 * The host timer behind the token bucket and the crystal of the capture
+	 * device feeding the pipe run at slightly different rates, and without
+	 * correction the difference accumulates over hours until the read
+	 * position underruns or overruns the pipe. To absorb the drift, the
+	 * operation tracks a moving average of the distance between the read
+	 * position and the write position, and whenever the average wanders away
+	 * from its initial value, the token bucket period is nudged one small
+	 * step towards the rate that keeps the distance steady. The adjustment
+	 * is bounded to a fraction of a permille around the nominal period, so a
+	 * misbehaving feeder can shift the pace only marginally.
 	 *
 	 * The transfer phase can be terminated when any exception is thrown. When
 	 * the transfer finishes, cleanup is done by stopping the capture device
@@ -16,6 +16,14 @@
 
 #include <alsa/asoundlib.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
 #include "exception.hpp"
 #include "timestamp.hpp"
 #include "buffer.hpp"
@@ -58,6 +66,90 @@ namespace Piper
 		}
 	}
 
+	/**
+	 * Check whether the given buffer contains only zero bytes. On SSE2
+	 * capable hosts the bulk of the buffer is scanned 16 bytes per
+	 * iteration; the remaining tail and non-SSE2 hosts fall back to a
+	 * byte-wise scan. The function stops at the first non-zero byte, so
+	 * scanning active blocks usually ends after reading a few bytes only.
+	 */
+	bool is_silent(const Buffer& buffer) noexcept
+	{
+		const char* start = buffer.start();
+		const std::size_t size = buffer.size();
+		std::size_t index = 0;
+
+#if defined(__SSE2__)
+		const __m128i zero = _mm_setzero_si128();
+
+		while (index + 16 <= size) {
+			const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(start + index));
+
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(data, zero)) != 0xffff) {
+				return false;
+			}
+
+			index += 16;
+		}
+#endif
+
+		while (index < size) {
+			if (start[index] != 0) {
+				return false;
+			}
+
+			index += 1;
+		}
+
+		return true;
+	}
+
+	/**
+	 * Calculate the CRC32C checksum of the given buffer. On SSE4.2 capable
+	 * hosts the bulk of the buffer is folded 8 bytes per instruction and
+	 * only the tail is handled byte-wise; other hosts fall back to a
+	 * portable bitwise implementation of the same polynomial, so checksums
+	 * stay comparable across mixed clients.
+	 */
+	std::uint32_t crc32c(const Buffer& buffer) noexcept
+	{
+		const char* start = buffer.start();
+		const std::size_t size = buffer.size();
+		std::uint32_t state = 0xffffffffu;
+		std::size_t index = 0;
+
+#if defined(__SSE4_2__)
+		std::uint64_t wide = state;
+
+		while (index + 8 <= size) {
+			std::uint64_t chunk;
+
+			std::memcpy(&chunk, start + index, sizeof(chunk));
+			wide = _mm_crc32_u64(wide, chunk);
+			index += 8;
+		}
+
+		state = static_cast<std::uint32_t>(wide);
+
+		while (index < size) {
+			state = _mm_crc32_u8(state, static_cast<unsigned char>(start[index]));
+			index += 1;
+		}
+#else
+		while (index < size) {
+			state ^= static_cast<unsigned char>(start[index]);
+
+			for (unsigned int bit = 0; bit < 8; bit++) {
+				state = (state >> 1) ^ (0x82f63b78u & (0u - (state & 1u)));
+			}
+
+			index += 1;
+		}
+#endif
+
+		return state ^ 0xffffffffu;
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 	//
 	// Metadata implementation.
@@ -181,9 +273,9 @@ namespace Piper
 	//
 	//////////////////////////////////////////////////////////////////////////
 
-	Pipe::Pipe(const char* path, const char* format, Channel channels, Rate rate, Duration period, unsigned int readable, unsigned int writable, unsigned int separation, unsigned int mode) :
+	Pipe::Pipe(const char* path, const char* format, Channel channels, Rate rate, Duration period, unsigned int readable, unsigned int writable, unsigned int separation, unsigned int mode, std::uint32_t options) :
 		m_metadata(format, channels, rate, period, readable, writable),
-		m_backer(path, Buffer(m_metadata), std::vector<std::size_t>{ sizeof(Preamble), m_metadata.m_period_size }, readable + writable + separation, mode),
+		m_backer(path, Buffer(m_metadata), std::vector<std::size_t>{ sizeof(Preamble), m_metadata.m_period_size, sizeof(Statistics) }, readable + writable + separation, mode, options),
 		m_medium(m_backer),
 		m_transport(m_medium)
 	{
@@ -202,10 +294,12 @@ namespace Piper
 	{
 		if (sizeof(Metadata) != m_backer.metadata_size()) {
 			EXC_START(PipeCorruptedException("[Piper::Pipe::Pipe] Cannot open pipe file due to file corruption"));
-		} else if (2 != m_backer.component_count()) {
+		} else if (2 != m_backer.component_count() && 3 != m_backer.component_count()) {
 			EXC_START(PipeCorruptedException("[Piper::Pipe::Pipe] Cannot open pipe file due to file corruption"));
 		} else if (sizeof(Preamble) != m_backer.component_size(0)) {
 			EXC_START(PipeCorruptedException("[Piper::Pipe::Pipe] Cannot open pipe file due to file corruption"));
+		} else if (3 == m_backer.component_count() && sizeof(Statistics) != m_backer.component_size(2)) {
+			EXC_START(PipeCorruptedException("[Piper::Pipe::Pipe] Cannot open pipe file due to file corruption"));
 		}
 
 		try {
@@ -237,6 +331,21 @@ namespace Piper
 		return snd_pcm_format_value(m_metadata.m_format);
 	}
 
+	Statistics* Pipe::statistics()
+	{
+		if (m_backer.component_count() >= 3) {
+			try {
+				return m_medium.component(0, 2).to_struct_pointer<Statistics>();
+			} catch (std::invalid_argument& ex) {
+				EXC_CHAIN(std::logic_error("[Piper::Pipe::statistics] Cannot return statistics block due to invalid argument to underlying component"));
+			} catch (std::logic_error& ex) {
+				EXC_CHAIN(std::logic_error("[Piper::Pipe::statistics] Cannot return statistics block due to logic error in underlying component"));
+			}
+		} else {
+			return nullptr;
+		}
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 	//
 	// Inlet implementation.
@@ -246,7 +355,8 @@ namespace Piper
 	Inlet::Inlet(Pipe& pipe) :
 		m_pipe(pipe),
 		m_transport(pipe.m_transport),
-		m_session(0)
+		m_session(0),
+		m_statistics(pipe.statistics())
 	{
 		try {
 			m_session = m_transport.begin();
@@ -283,11 +393,20 @@ namespace Piper
 
 	void Inlet::flush()
 	{
+		Preamble& header(preamble(start()));
+
+		header.checksum = crc32c(content(start()));
+		header.flags |= Preamble::FLAG_CHECKSUM;
+
 		try {
 			m_transport.flush(m_session);
 		} catch (std::invalid_argument& ex) {
 			EXC_CHAIN(std::logic_error("[Piper::Inlet::flush] Cannot flush the inlet due to corrupted session"));
 		}
+
+		if (m_statistics != nullptr) {
+			m_statistics->writes.fetch_add(1, std::memory_order_relaxed);
+		}
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -318,6 +437,17 @@ namespace Piper
 		}
 	}
 
+	bool Outlet::verify(Position position) const
+	{
+		const Preamble& header(preamble(position));
+
+		if ((header.flags & Preamble::FLAG_CHECKSUM) == 0) {
+			return true;
+		} else {
+			return crc32c(content(position)) == header.checksum;
+		}
+	}
+
 	void Outlet::watch() const
 	{
 		watch(-1);
@@ -325,48 +455,12 @@ namespace Piper
 
 	void Outlet::watch(int timeout) const
 	{
-		if (timeout == -1) {
-			Position current = m_transport.until();
-			Duration period = m_pipe.period_time();
-			
-			while (m_transport.until() == current) {
-				Duration limit = period * (m_transport.active() ? 1 : 10);
-	
-				struct timespec wait;
-				wait.tv_sec = static_cast<time_t>(limit / 1000000000);
-				wait.tv_nsec = static_cast<long>(limit % 1000000000);
-	
-				if (::nanosleep(&wait, nullptr) < 0) {
-					switch (errno) {
-						case EINTR: return;
-						case EINVAL: EXC_START(std::logic_error("[Piper::Outlet::watch] Cannot watch for incoming blocks due to unexpected sleep error"));
-						default: EXC_START(EXC_SYSTEM(errno), PipeWatchException("[Piper::Outlet::watch] Cannot watch for incoming blocks due to operating system error"));
-					}
-				}
-			}
-		}
-
-		while (timeout > 0) {
-			Position current = m_transport.until();
-			Duration period = m_pipe.period_time();
-
-			while (m_transport.until() == current) {
-				int limit = static_cast<int>(period / 1000000) * (m_transport.active() ? 1 : 10);
-				int slice = std::min(timeout, limit);
-				timeout -= slice;
-
-				struct timespec wait;
-				wait.tv_sec = static_cast<time_t>(slice / 1000);
-				wait.tv_nsec = static_cast<long>((slice % 1000) * 1000000);
-
-				if (::nanosleep(&wait, nullptr) < 0) {
-					switch (errno) {
-						case EINTR: return;
-						case EINVAL: EXC_START(std::logic_error("[Piper::Outlet::watch] Cannot watch for incoming blocks due to unexpected sleep error"));
-						default: EXC_START(EXC_SYSTEM(errno), PipeWatchException("[Piper::Outlet::watch] Cannot watch for incoming blocks due to operating system error"));
-					}
-				}
-			}
+		try {
+			m_transport.wait(m_transport.middle(), timeout);
+		} catch (std::logic_error& ex) {
+			EXC_CHAIN(std::logic_error("[Piper::Outlet::watch] Cannot watch for incoming blocks due to logic error in underlying component"));
+		} catch (TransportException& ex) {
+			EXC_CHAIN(PipeWatchException("[Piper::Outlet::watch] Cannot watch for incoming blocks due to operating system error"));
 		}
 	}
 
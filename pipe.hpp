@@ -1,5 +1,6 @@
 
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <exception>
@@ -35,17 +36,108 @@ namespace Piper
 	typedef std::uint32_t Rate;
 
 	/**
-	 * Preamble stores information about a block in the pipe. It primarily
-	 * contains the timestamp of the block.
+	 * Preamble stores information about a block in the pipe. It contains
+	 * the timestamps of the block plus a set of flags describing the block
+	 * content.
+	 *
+	 * The block carries two timestamps. The pipeline timestamp records when
+	 * the block is flushed into the pipe, and the capture timestamp records
+	 * when the newest sample of the block left the capture device according
+	 * to the device driver. The difference between the two exposes the
+	 * device buffering and the feed processing time, so drain clients can
+	 * attribute latency to the individual stages instead of a single
+	 * end-to-end number. Feed clients without a device clock leave the
+	 * capture timestamp at zero.
+	 *
+	 * The silence flag marks blocks that contain only zero samples. Feed
+	 * clients set the flag after scanning the block, so that drain clients
+	 * can deliver the block from a cached silence buffer without touching
+	 * the block data at all.
+	 *
+	 * The checksum flag marks blocks whose preamble carries a CRC32C
+	 * checksum of the block content. The inlet fills the checksum when the
+	 * block is flushed, so that readers can verify the block integrity and
+	 * detect content corrupted by a host crash instead of replaying it.
+	 * Blocks without the flag, like those written by older clients, carry
+	 * no checksum and verify trivially.
 	 */
 	struct Preamble
 	{
+		/**
+		 * Flag indicating that the block contains only zero samples.
+		 */
+		static const std::uint32_t FLAG_SILENCE = 0x1;
+
+		/**
+		 * Flag indicating that the checksum field carries a CRC32C checksum
+		 * of the block content.
+		 */
+		static const std::uint32_t FLAG_CHECKSUM = 0x2;
+
 		Timestamp timestamp;
+		Timestamp capture;
+		std::uint32_t flags;
+		std::uint32_t checksum;
+
+		explicit Preamble() : timestamp(now()), capture(0), flags(0), checksum(0) {}
+		explicit Preamble(Timestamp initial) : timestamp(initial), capture(0), flags(0), checksum(0) {}
+	};
+
+	/**
+	 * Check whether the given buffer contains only zero bytes. The function
+	 * is used by feed clients to detect silent blocks and tag them with the
+	 * silence flag in their preambles.
+	 */
+	bool is_silent(const Buffer& buffer) noexcept;
+
+	/**
+	 * Calculate the CRC32C checksum of the given buffer. The function is
+	 * used to fill and verify the block checksum in the preamble. On SSE4.2
+	 * capable targets the checksum uses the hardware instruction and costs
+	 * a few cycles per cache line; elsewhere a portable bitwise fallback
+	 * handles the buffer.
+	 */
+	std::uint32_t crc32c(const Buffer& buffer) noexcept;
 
-		explicit Preamble() : timestamp(now()) {}
-		explicit Preamble(Timestamp initial) : timestamp(initial) {}
+	/**
+	 * Statistics stores live counters about a pipe. The block lives in its
+	 * own component of the backing file, so feed and drain clients can
+	 * publish counters there and diagnostic tools can attach to the pipe
+	 * and read them without perturbing the clients.
+	 *
+	 * `writes` counts the blocks flushed into the pipe and `reads` counts
+	 * the blocks consumed by drain clients; their difference indicates the
+	 * current buffer fill level. `overruns` counts the periods the clients
+	 * fell behind the pipe schedule. `latencies` is a histogram of block
+	 * write-to-read delays with power-of-two millisecond buckets, starting
+	 * from under 1 ms up to 64 ms and beyond.
+	 */
+	struct Statistics
+	{
+		std::atomic<std::uint64_t> writes;
+		std::atomic<std::uint64_t> reads;
+		std::atomic<std::uint64_t> overruns;
+		std::atomic<std::uint64_t> latencies[8];
 	};
 
+	/**
+	 * Calculate the latency histogram bucket for the given block delay. The
+	 * function encodes the bucket contract of the latency histogram in the
+	 * statistics block: the buckets cover power-of-two millisecond ranges,
+	 * starting from below one millisecond up to 64 milliseconds and beyond.
+	 */
+	inline std::size_t latency_bucket(Timestamp delay) noexcept
+	{
+		Timestamp milliseconds = (delay >= 0 ? delay / 1000000 : 0);
+		std::size_t bucket = 0;
+
+		while (bucket < 7 && milliseconds >= (Timestamp(1) << bucket)) {
+			bucket += 1;
+		}
+
+		return bucket;
+	}
+
 	/**
 	 * Pipe is a specialization of channel.
 	 */
@@ -54,10 +146,13 @@ namespace Piper
 		public:
 
 			/**
-			 * Create a new pipe with the given parameters. The method will
-			 * throw exception when it cannot create the file.
+			 * Create a new pipe with the given parameters. The options are a
+			 * bitmask of the mapping option flags defined on the backer; they
+			 * are saved in the pipe file and honored by every process mapping
+			 * the pipe afterwards. The method will throw exception when it
+			 * cannot create the file.
 			 */
-			explicit Pipe(const char* path, const char* format, Channel channels, Rate rate, Duration period, unsigned int readable, unsigned int writable, unsigned int separation, unsigned int mode);
+			explicit Pipe(const char* path, const char* format, Channel channels, Rate rate, Duration period, unsigned int readable, unsigned int writable, unsigned int separation, unsigned int mode, std::uint32_t options = 0);
 
 			/**
 			 * Open an existing pipe. The method will throw exception when it
@@ -156,6 +251,13 @@ namespace Piper
 			 */
 			std::size_t capacity_size() const noexcept { return m_metadata.m_period_size * m_backer.slot_count(); }
 
+			/**
+			 * Return the pointer to the statistics block of the pipe, or nullptr
+			 * when the pipe file predates the statistics component and does not
+			 * carry one.
+			 */
+			Statistics* statistics();
+
 			Pipe(const Pipe& pipe) = delete;
 			Pipe(Pipe&& pipe) = delete;
 			Pipe& operator=(const Pipe& pipe) = delete;
@@ -170,7 +272,7 @@ namespace Piper
 			 * Pipe metadata version code specifies the version of the metadata
 			 * header.
 			 */
-			static const std::uint32_t VERSION = 1;
+			static const std::uint32_t VERSION = 3;
 
 			/**
 			 * Format length is a constant representing the maximum length of format
@@ -229,7 +331,9 @@ namespace Piper
 
 			/**
 			 * Create a new inlet into the given pipe. Throws concurrent session
-			 * exception when another outlet is created for the pipe.
+			 * exception when another outlet is created for the pipe. A session
+			 * left behind by a dead process is taken over automatically, so a
+			 * restarted writer does not have to unclog the pipe first.
 			 */
 			explicit Inlet(Pipe& pipe);
 
@@ -276,7 +380,9 @@ namespace Piper
 			/**
 			 * Flush the first staging block. The staging block will be converted to
 			 * a cousmable block, and a new staging block will be appended to the
-			 * end of the pipe.
+			 * end of the pipe. Before the conversion, the content checksum of the
+			 * block is filled into its preamble and the checksum flag is raised,
+			 * so that readers can verify the block integrity.
 			 */
 	    void flush();
 
@@ -290,7 +396,8 @@ namespace Piper
 			Pipe& m_pipe;
 			Transport& m_transport;
 			Session m_session;
-			
+			Statistics* m_statistics;
+
 	};
 
 	/**
@@ -303,9 +410,16 @@ namespace Piper
 			typedef Transport::Position Position;
 
 			/**
-			 * Create a new outlet from the given pipe.
+			 * Create a new outlet from the given pipe. The outlet will claim a
+			 * shared read cursor slot from the transport when one is free, so
+			 * that the writer and diagnostic tools can observe its progress.
+			 */
+			explicit Outlet(Pipe& pipe) : m_pipe(pipe), m_transport(m_pipe.m_transport), m_cursor(m_transport.claim_cursor()) {}
+
+			/**
+			 * Destroy this outlet and release any claimed read cursor slot.
 			 */
-			explicit Outlet(Pipe& pipe) : m_pipe(pipe), m_transport(m_pipe.m_transport) {}
+			~Outlet() { m_transport.release_cursor(m_cursor); }
 
 			/**
 			 * Return the pipe.
@@ -343,6 +457,22 @@ namespace Piper
 			 */
 			const Buffer content(Position position) const;
 
+			/**
+			 * Verify the integrity of the given readable block. The method
+			 * returns true when the block carries a matching content checksum
+			 * or no checksum at all, and false when the checksum does not
+			 * match the block content. A mismatch indicates that the block
+			 * was corrupted, for example by a host crash, and should not be
+			 * consumed.
+			 */
+			bool verify(Position position) const;
+
+			/**
+			 * Publish the current read position to the claimed read cursor
+			 * slot. The method is a no-op when no slot could be claimed.
+			 */
+			void mark(Position position) { m_transport.update_cursor(m_cursor, position); }
+
 			/**
 			 * Watch for next writes to the pipe. The method will return when the
 			 * pipe is written with new blocks, or when the calling process receives
@@ -366,6 +496,7 @@ namespace Piper
 
 			Pipe& m_pipe;
 			Transport& m_transport;
+			unsigned int m_cursor;
 
 	};
 
@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <limits>
 #include <stdexcept>
 #include <memory>
 #include <mutex>
@@ -67,7 +68,12 @@
  * correspond to the device hardware pointer plus `m_expiration` periods
  * while the device is in the PREPARED or RUNNING state. The invariant is
  * essential for data transfer and violation can cause corruption of audio
- * data.
+ * data. In the counter driven pointer mode, the checkpoint stored in the
+ * class takes over the role of `m_expiration`: it records the first
+ * writable block of the pipe as of the last hardware pointer update, so
+ * the hardware pointer should always correspond to the checkpoint and
+ * flushed periods can be counted by comparing the checkpoint against the
+ * write counter of the transport.
  *
  * The next invariant is that the buffer size stored in the class should
  * match the real device buffer of the class. The size stored in the class
@@ -102,15 +108,24 @@ class PiperPlaybackHandler : public ALSA::IOPlug::Implementation
 		enum class Status { IDLE = 0, ACTIVE = 1, END = 2 };
 
 		/**
-		 * Construct a new piper playback handler.
+		 * Construct a new piper playback handler. The counter flag selects
+		 * the counter driven pointer mode, where the hardware pointer is
+		 * derived from the write counter of the transport instead of the
+		 * timer expiration count. The prefill value selects the number of
+		 * periods the client has to deliver before the device starts itself;
+		 * zero disables the self start and leaves the start decision to the
+		 * client alone.
 		 */
-		PiperPlaybackHandler(const char* path) :
+		PiperPlaybackHandler(const char* path, bool counter, unsigned int prefill) :
 			m_pipe(path),
 			m_inlet(m_pipe),
 			m_timer(m_pipe.period_time()),
 			m_signpost(),
 			m_buffer(0),
 			m_expirations(0),
+			m_counter(counter),
+			m_checkpoint(m_inlet.start()),
+			m_prefill(prefill),
 			m_transfer_source(m_pipe.format_code_alsa(), m_pipe.channels()),
 			m_transfer_target(m_pipe.format_code_alsa(), m_pipe.channels()),
 			m_status(Status::IDLE),
@@ -191,6 +206,7 @@ class PiperPlaybackHandler : public ALSA::IOPlug::Implementation
 			m_status = Status::IDLE;
 			m_buffer = control.buffer_size() / control.period_size();
 			m_expirations = 0;
+			m_checkpoint = m_inlet.start();
 			m_signpost.activate();
 
 			const Piper::Inlet::Position clear_start = m_inlet.start();
@@ -237,6 +253,7 @@ class PiperPlaybackHandler : public ALSA::IOPlug::Implementation
 			m_timer.stop();
 			m_signpost.deactivate();
 			m_expirations = 0;
+			m_checkpoint = m_inlet.start();
 			m_buffer = 0;
 			m_status = Status::IDLE;
 		}
@@ -303,15 +320,21 @@ class PiperPlaybackHandler : public ALSA::IOPlug::Implementation
 		 *
 		 * First of all, this callback will retrieve the buffer usage according to
 		 * the current hardware pointer, plus the number of frames flushed by the
-		 * pump thread but unaccounted for by the current hardware pointer.
+		 * pump thread but unaccounted for by the current hardware pointer. In the
+		 * timer driven mode the flushed frames are counted from the expiration
+		 * count accumulated by the pump thread; in the counter driven mode they
+		 * are derived by comparing the write counter of the transport against
+		 * the checkpoint, which costs a single atomic load from the mapped pipe
+		 * header and does not depend on timer bookkeeping.
 		 *
 		 * If the buffer usage is less than the flushed frame, the pump thread
 		 * should have pumped past the current application pointer and buffer
 		 * underrun occured. In such case, stop the playback and report the error.
 		 *
 		 * If everything is OK, the callback will take a few actions. It should
-		 * reset the expiration count to zero since the hardware pointer and the
-		 * first writable block of the pipe should once again align.
+		 * reset the expiration count to zero and move the checkpoint to the
+		 * first writable block since the hardware pointer and the first writable
+		 * block of the pipe should once again align.
 		 */
 		snd_pcm_uframes_t pointer(ALSA::IOPlug::Control& control)
 		{
@@ -319,9 +342,11 @@ class PiperPlaybackHandler : public ALSA::IOPlug::Implementation
 
 			const snd_pcm_uframes_t period = control.period_size();
 			const snd_pcm_uframes_t used = control.buffer_used();
-			const snd_pcm_uframes_t flushed = m_expirations * period;
+			const Piper::Inlet::Position start = m_inlet.start();
+			const snd_pcm_uframes_t flushed = (m_counter ? (start - m_checkpoint) * period : m_expirations * period);
 
 			m_expirations = 0;
+			m_checkpoint = start;
 
 			if (used < flushed) {
 				SNDERR("device cannot be polled: underrun");
@@ -342,7 +367,8 @@ class PiperPlaybackHandler : public ALSA::IOPlug::Implementation
 		 *
 		 * First of all, this callback will retrieve the buffer usage according to
 		 * the current hardware pointer, plus the number of frames flushed by the
-		 * pump thread but unaccounted for by the current hardware pointer.
+		 * pump thread but unaccounted for by the current hardware pointer. The
+		 * flushed frames are counted the same way as in the pointer callback.
 		 *
 		 * If the buffer usage is less than the flushed frame, the pump thread
 		 * should have pumped past the current application pointer and buffer
@@ -353,6 +379,15 @@ class PiperPlaybackHandler : public ALSA::IOPlug::Implementation
 		 * the amount of data to be copied should the buffer has limited space.
 		 * After that, the audio data is copied.
 		 *
+		 * After the copy, if the prefill threshold is configured and the device
+		 * is still in the PREPARED state, the callback will check the buffer
+		 * usage against the threshold. Once the client has delivered enough
+		 * periods, the callback will move the device to the RUNNING state and
+		 * start the playback by itself, so short sounds begin playing after as
+		 * little as one period instead of waiting for the client to fill the
+		 * whole buffer. The rest of the buffer can then be filled while the
+		 * playback runs.
+		 *
 		 * Before returning, the signpost should be updated to reflect the amount
 		 * of free space still available for transfer.
 		 *
@@ -368,7 +403,8 @@ class PiperPlaybackHandler : public ALSA::IOPlug::Implementation
 			const snd_pcm_uframes_t period = control.period_size();
 			const snd_pcm_uframes_t used = control.buffer_used();
 			const snd_pcm_uframes_t free = control.buffer_free();
-			const snd_pcm_uframes_t flushed = m_expirations * period;
+			const Piper::Inlet::Position start = m_inlet.start();
+			const snd_pcm_uframes_t flushed = (m_counter ? (start - m_checkpoint) * period : m_expirations * period);
 
 			if (used < flushed) {
 				SNDERR("device cannot be written: underrun");
@@ -381,7 +417,7 @@ class PiperPlaybackHandler : public ALSA::IOPlug::Implementation
 			}
 
 			Piper::Inlet::Position increment = used / period;
-			Piper::Inlet::Position block = m_inlet.start() - m_expirations + increment;
+			Piper::Inlet::Position block = (m_counter ? m_checkpoint : start - m_expirations) + increment;
 			Piper::Buffer buffer = m_inlet.content(block);
 			snd_pcm_uframes_t pending = size;
 			snd_pcm_uframes_t done = 0;
@@ -413,6 +449,17 @@ class PiperPlaybackHandler : public ALSA::IOPlug::Implementation
 				pending -= copied;
 			}
 
+			if (m_prefill > 0 && m_status == Status::IDLE && control.state() == SND_PCM_STATE_PREPARED) {
+				const snd_pcm_uframes_t limit = m_buffer * period;
+				const snd_pcm_uframes_t threshold = std::min(m_prefill * period, limit);
+
+				if (used + done >= threshold) {
+					control.set_state(SND_PCM_STATE_RUNNING);
+					m_status = Status::ACTIVE;
+					m_timer.start();
+				}
+			}
+
 			if (free + flushed - done > 0) {
 				m_signpost.activate();
 			} else {
@@ -470,7 +517,9 @@ class PiperPlaybackHandler : public ALSA::IOPlug::Implementation
 						const Piper::Inlet::Position clear_until = clear_start + outstanding;
 
 						for (Piper::Inlet::Position position = flush_start; position < flush_until; position++) {
-							m_inlet.preamble(position).timestamp = Piper::now();
+							Piper::Preamble& preamble = m_inlet.preamble(position);
+							preamble.timestamp = Piper::now();
+							preamble.flags = (Piper::is_silent(m_inlet.content(position)) ? Piper::Preamble::FLAG_SILENCE : 0);
 							m_inlet.flush();
 						}
 
@@ -539,6 +588,29 @@ class PiperPlaybackHandler : public ALSA::IOPlug::Implementation
 		 */
 		Piper::Inlet::Position m_expirations;
 
+		/**
+		 * Flag selecting the counter driven pointer mode. When set, hardware
+		 * pointer updates are derived from the write counter of the transport
+		 * instead of the expiration count.
+		 */
+		bool m_counter;
+
+		/**
+		 * First writable block of the pipe as of the last hardware pointer
+		 * update. It is used in the counter driven pointer mode to calculate
+		 * hardware pointer updates as well as to translate application pointers
+		 * to corresponding pipe positions.
+		 */
+		Piper::Inlet::Position m_checkpoint;
+
+		/**
+		 * Number of periods the client has to deliver before the device starts
+		 * itself from the PREPARED state. Zero disables the self start and the
+		 * playback begins only when the client starts the device. The value is
+		 * clamped to the device buffer size during the check.
+		 */
+		snd_pcm_uframes_t m_prefill;
+
 		/**
 		 * ALSA range where data is transferred from. It helps with data copy in
 		 * the transfer method.
@@ -934,12 +1006,19 @@ extern "C"
 	/**
 	 * Open the piper device. The function will parse the device configuration
 	 * and initialize the appropriate IOPlug device according to the stream
-	 * type.
+	 * type. The optional pointer field selects how the playback device tracks
+	 * its hardware pointer: `timer` (the default) extrapolates it from timer
+	 * expirations, while `counter` derives it from the write counter of the
+	 * transport. The optional prefill field gives the number of periods the
+	 * client has to deliver before the playback device starts itself; zero
+	 * (the default) leaves the start decision to the client alone.
 	 */
 	SND_PCM_PLUGIN_DEFINE_FUNC(piper)
 	{
 		snd_config_iterator_t i, next;
 		const char* path;
+		const char* mode_name = "timer";
+		long prefill = 0;
 
 		snd_config_for_each(i, next, conf) {
 			snd_config_t* n = snd_config_iterator_entry(i);
@@ -963,6 +1042,22 @@ extern "C"
 					SNDERR("device %s cannot be initialized: invalid capture %s in config", name, path);
 					return -EINVAL;
 				}
+			} else if (std::strcmp(id, "pointer") == 0) {
+				if (snd_config_get_string(n, &mode_name) < 0) {
+					SNDERR("device %s cannot be initialized: invalid pointer %s in config", name, mode_name);
+					return -EINVAL;
+				} else if (std::strcmp(mode_name, "timer") != 0 && std::strcmp(mode_name, "counter") != 0) {
+					SNDERR("device %s cannot be initialized: unknown pointer mode %s in config", name, mode_name);
+					return -EINVAL;
+				}
+			} else if (std::strcmp(id, "prefill") == 0) {
+				if (snd_config_get_integer(n, &prefill) < 0) {
+					SNDERR("device %s cannot be initialized: invalid prefill in config", name);
+					return -EINVAL;
+				} else if (prefill < 0 || static_cast<unsigned long>(prefill) > std::numeric_limits<unsigned int>::max()) {
+					SNDERR("device %s cannot be initialized: invalid prefill %ld in config", name, prefill);
+					return -EINVAL;
+				}
 			} else {
 				SNDERR("device %s cannot be initialized: unknown field %s in config", name, id);
 				return -EINVAL;
@@ -971,7 +1066,7 @@ extern "C"
 
 		try {
 			if (stream == SND_PCM_STREAM_PLAYBACK) {
-				ALSA::IOPlug ioplug{name, stream, mode, std::unique_ptr<ALSA::IOPlug::Implementation>(new PiperPlaybackHandler(path))};
+				ALSA::IOPlug ioplug{name, stream, mode, std::unique_ptr<ALSA::IOPlug::Implementation>(new PiperPlaybackHandler(path, std::strcmp(mode_name, "counter") == 0, static_cast<unsigned int>(prefill)))};
 				*pcmp = ioplug.release();
 				return 0;
 			} else if (stream == SND_PCM_STREAM_CAPTURE) {
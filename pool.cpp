@@ -0,0 +1,214 @@
+
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include "exception.hpp"
+#include "pool.hpp"
+
+
+#define EXC_START(...) Support::Exception::start(__VA_ARGS__, "pool.cpp", __LINE__)
+#define EXC_CHAIN(...) Support::Exception::chain(__VA_ARGS__, "pool.cpp", __LINE__);
+
+
+namespace Support
+{
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Pool implementation.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	Pool::Pool(unsigned int workers) :
+		m_queues(),
+		m_workers(),
+		m_mutex(),
+		m_available(),
+		m_submissions(0),
+		m_ending(false)
+	{
+		if (workers == 0) {
+			EXC_START(std::invalid_argument("[Support::Pool::Pool] Cannot create pool due to invalid worker count"));
+		}
+
+		for (unsigned int i = 0; i < workers; i++) {
+			m_queues.emplace_back(new Queue());
+		}
+
+		try {
+			for (unsigned int i = 0; i < workers; i++) {
+				m_workers.emplace_back(&Pool::run, this, std::size_t(i));
+			}
+		} catch (std::system_error& ex) {
+			{
+				std::lock_guard<std::mutex> guard(m_mutex);
+				m_ending = true;
+			}
+
+			m_available.notify_all();
+
+			for (std::thread& worker : m_workers) {
+				worker.join();
+			}
+
+			EXC_CHAIN(PoolException("[Support::Pool::Pool] Cannot create pool due to operating system error"));
+		}
+	}
+
+	Pool::~Pool()
+	{
+		{
+			std::lock_guard<std::mutex> guard(m_mutex);
+			m_ending = true;
+		}
+
+		m_available.notify_all();
+
+		for (std::thread& worker : m_workers) {
+			worker.join();
+		}
+	}
+
+	void Pool::submit(std::size_t hint, Task task)
+	{
+		Queue& queue(*m_queues[hint % m_queues.size()]);
+
+		{
+			std::lock_guard<std::mutex> guard(queue.mutex);
+			queue.tasks.push_back(std::move(task));
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(m_mutex);
+			m_submissions += 1;
+		}
+
+		m_available.notify_one();
+	}
+
+	bool Pool::fetch(std::size_t index, Task& task)
+	{
+		{
+			Queue& queue(*m_queues[index]);
+			std::lock_guard<std::mutex> guard(queue.mutex);
+
+			if (queue.tasks.empty() == false) {
+				task = std::move(queue.tasks.front());
+				queue.tasks.pop_front();
+				return true;
+			}
+		}
+
+		for (std::size_t i = 1; i < m_queues.size(); i++) {
+			Queue& queue(*m_queues[(index + i) % m_queues.size()]);
+			std::lock_guard<std::mutex> guard(queue.mutex);
+
+			if (queue.tasks.empty() == false) {
+				task = std::move(queue.tasks.back());
+				queue.tasks.pop_back();
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void Pool::run(std::size_t index)
+	{
+		Task task;
+
+		while (true) {
+			std::uint64_t mark;
+
+			{
+				std::lock_guard<std::mutex> guard(m_mutex);
+				mark = m_submissions;
+			}
+
+			if (fetch(index, task)) {
+				task();
+				task = Task();
+			} else {
+				std::unique_lock<std::mutex> guard(m_mutex);
+
+				while (m_ending == false && m_submissions == mark) {
+					m_available.wait(guard);
+				}
+
+				if (m_ending && m_submissions == mark) {
+					return;
+				}
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Batch implementation.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	Batch::~Batch()
+	{
+		std::unique_lock<std::mutex> guard(m_mutex);
+
+		while (m_pending > 0) {
+			m_finished.wait(guard);
+		}
+	}
+
+	void Batch::submit(Pool::Task task)
+	{
+		{
+			std::lock_guard<std::mutex> guard(m_mutex);
+			m_pending += 1;
+		}
+
+		m_pool.submit(m_next++, [this, task]() {
+			std::exception_ptr failure;
+
+			try {
+				task();
+			} catch (...) {
+				failure = std::current_exception();
+			}
+
+			{
+				std::lock_guard<std::mutex> guard(m_mutex);
+
+				if (failure != nullptr && m_failure == nullptr) {
+					m_failure = failure;
+				}
+
+				m_pending -= 1;
+
+				if (m_pending == 0) {
+					m_finished.notify_all();
+				}
+			}
+		});
+	}
+
+	void Batch::wait()
+	{
+		std::unique_lock<std::mutex> guard(m_mutex);
+
+		while (m_pending > 0) {
+			m_finished.wait(guard);
+		}
+
+		if (m_failure != nullptr) {
+			std::exception_ptr failure(m_failure);
+			m_failure = nullptr;
+			guard.unlock();
+			std::rethrow_exception(failure);
+		}
+	}
+
+}
+
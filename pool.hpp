@@ -0,0 +1,257 @@
+
+
+#include <cstddef>
+#include <cstdint>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "exception.hpp"
+
+
+#ifndef POOL_HPP_
+#define POOL_HPP_
+
+
+namespace Support
+{
+
+	/**
+	 * Pool implements a small fixed set of worker threads for per-period
+	 * jobs like conversion kernels, mix accumulation, checksum calculation
+	 * and silence scanning.
+	 *
+	 * Overview
+	 * ========
+	 *
+	 * A pool owns a fixed number of worker threads created at construction
+	 * time. Work is handed to the pool in batches: a batch collects a group
+	 * of independent tasks, distributes them over the workers, and lets the
+	 * submitting thread wait for the whole group to complete. The submitting
+	 * loop therefore keeps full control over ordering; it submits the tasks
+	 * of one period, waits for the batch, and only then publishes the result
+	 * downstream.
+	 *
+	 * Implementation Details
+	 * ======================
+	 *
+	 * Each worker thread owns a task queue. Submitted tasks are spread over
+	 * the queues round robin, and an idle worker first drains its own queue
+	 * from the front and then steals from the back of the other queues, so
+	 * an uneven batch is rebalanced by the idle workers instead of stalling
+	 * on the busiest one. Workers sleep on a condition variable while every
+	 * queue is empty.
+	 *
+	 * Issues
+	 * ======
+	 *
+	 * The queues are guarded by plain mutexes rather than lock free deques.
+	 * Tasks in this codebase cover at least a period worth of samples, so
+	 * the locking cost is insignificant next to the task body; the simpler
+	 * structure was preferred over the classic lock free work stealing
+	 * deque.
+	 *
+	 */
+	class Pool
+	{
+		public:
+
+			/**
+			 * Type of tasks accepted by the pool. A task is a callable without
+			 * arguments or results; data is passed by capture.
+			 */
+			typedef std::function<void()> Task;
+
+			/**
+			 * Construct a new pool with the given number of worker threads.
+			 * Throws invalid argument exception when the worker count is zero;
+			 * throws pool exception when the threads cannot be created.
+			 */
+			explicit Pool(unsigned int workers);
+
+			/**
+			 * Destroy the pool. The destructor finishes the tasks already in
+			 * the queues, then stops and joins every worker thread.
+			 */
+			~Pool();
+
+			/**
+			 * Return the number of worker threads in the pool.
+			 */
+			unsigned int workers() const noexcept { return static_cast<unsigned int>(m_workers.size()); }
+
+			Pool(const Pool& pool) = delete;
+			Pool(Pool&& pool) = delete;
+			Pool& operator=(const Pool& pool) = delete;
+			Pool& operator=(Pool&& pool) = delete;
+
+		private:
+
+			friend class Batch;
+
+			/**
+			 * Queue of pending tasks owned by a single worker. The owner takes
+			 * tasks from the front and thieves take tasks from the back.
+			 */
+			struct Queue
+			{
+				std::mutex mutex;
+				std::deque<Task> tasks;
+			};
+
+			/**
+			 * Push the given task onto the queue selected by the hint and wake
+			 * a sleeping worker.
+			 */
+			void submit(std::size_t hint, Task task);
+
+			/**
+			 * Take a pending task into the given reference and return whether
+			 * one was found. The queue owned by the given worker is drained
+			 * from the front first; the queues of the other workers are then
+			 * tried from the back.
+			 */
+			bool fetch(std::size_t index, Task& task);
+
+			/**
+			 * Main loop of a single worker thread. The loop runs pending tasks
+			 * until the pool winds down and every queue is drained.
+			 */
+			void run(std::size_t index);
+
+			/**
+			 * Task queues, one per worker thread.
+			 */
+			std::vector<std::unique_ptr<Queue>> m_queues;
+
+			/**
+			 * Worker threads of the pool.
+			 */
+			std::vector<std::thread> m_workers;
+
+			/**
+			 * Mutex guarding the submission counter and the ending flag.
+			 */
+			std::mutex m_mutex;
+
+			/**
+			 * Condition variable where idle workers sleep until the next
+			 * submission or wind down.
+			 */
+			std::condition_variable m_available;
+
+			/**
+			 * Counter incremented on every submission. A worker snapshots the
+			 * counter before scanning the queues and sleeps only while the
+			 * counter is unchanged, so a submission between scan and sleep is
+			 * never missed.
+			 */
+			std::uint64_t m_submissions;
+
+			/**
+			 * Flag indicating that the pool is winding down.
+			 */
+			bool m_ending;
+
+	};
+
+	/**
+	 * Batch collects a group of independent tasks submitted to a pool and
+	 * lets the submitting thread wait for the whole group.
+	 *
+	 * A batch remembers the number of outstanding tasks and the first
+	 * exception thrown by any of them. The wait member function blocks until
+	 * every task of the batch has finished and then rethrows that exception
+	 * in the submitting thread, so task failures surface on the same path
+	 * as failures of inline code. A batch has to outlive its tasks and is
+	 * intended to live on the stack of the submitting loop, one batch per
+	 * period.
+	 */
+	class Batch
+	{
+		public:
+
+			/**
+			 * Construct a new batch over the given pool.
+			 */
+			explicit Batch(Pool& pool) : m_pool(pool), m_next(0), m_pending(0), m_failure() {}
+
+			/**
+			 * Destroy the batch. The destructor waits for the outstanding
+			 * tasks but discards any captured exception; call wait explicitly
+			 * to observe task failures.
+			 */
+			~Batch();
+
+			/**
+			 * Submit the given task to the pool as part of the batch.
+			 */
+			void submit(Pool::Task task);
+
+			/**
+			 * Wait until every task of the batch has finished. When any task
+			 * has thrown, the first captured exception is rethrown after the
+			 * wait.
+			 */
+			void wait();
+
+			Batch(const Batch& batch) = delete;
+			Batch(Batch&& batch) = delete;
+			Batch& operator=(const Batch& batch) = delete;
+			Batch& operator=(Batch&& batch) = delete;
+
+		private:
+
+			/**
+			 * Pool serving the batch.
+			 */
+			Pool& m_pool;
+
+			/**
+			 * Round robin hint for spreading tasks over the worker queues.
+			 */
+			std::size_t m_next;
+
+			/**
+			 * Mutex guarding the outstanding count and the captured failure.
+			 */
+			std::mutex m_mutex;
+
+			/**
+			 * Condition variable notified when the outstanding count reaches
+			 * zero.
+			 */
+			std::condition_variable m_finished;
+
+			/**
+			 * Number of submitted tasks that have not finished yet.
+			 */
+			std::size_t m_pending;
+
+			/**
+			 * First exception thrown by a task of the batch.
+			 */
+			std::exception_ptr m_failure;
+
+	};
+
+	/**
+	 * Exception thrown when a pool cannot be created or operated.
+	 */
+	class PoolException : public std::runtime_error
+	{
+		public:
+			using std::runtime_error::runtime_error;
+	};
+
+}
+
+
+#endif
+
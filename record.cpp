@@ -0,0 +1,311 @@
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <system_error>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "exception.hpp"
+#include "timestamp.hpp"
+#include "buffer.hpp"
+#include "file.hpp"
+#include "pipe.hpp"
+#include "operation.hpp"
+#include "record.hpp"
+
+
+#define EXC_SYSTEM(err) std::system_error(err, std::system_category(), strerror(err))
+#define EXC_START(...) Support::Exception::start(__VA_ARGS__, "record.cpp", __LINE__)
+#define EXC_CHAIN(...) Support::Exception::chain(__VA_ARGS__, "record.cpp", __LINE__);
+
+
+namespace Piper
+{
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Recording file format.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	/**
+	 * Recording file version code specifies the version of the recording
+	 * header.
+	 */
+	static const std::uint32_t RECORDING_VERSION = 1;
+
+	/**
+	 * Number of blocks the recording file is grown by per truncate call.
+	 */
+	static const std::uint64_t RECORDING_EXTENT = 256;
+
+	/**
+	 * Number of blocks recorded between asynchronous flushes of the
+	 * recording file.
+	 */
+	static const std::uint64_t RECORDING_SYNC_INTERVAL = 64;
+
+	/**
+	 * Recording header describes the audio parameters of the recorded pipe
+	 * and the number of recorded blocks. It occupies the first page of the
+	 * recording file; the recorded blocks follow, tightly packed, each one
+	 * storing the block preamble followed by the block content.
+	 */
+	struct RecordingHeader
+	{
+		std::uint32_t version;
+		char format[28];
+		std::uint32_t channels;
+		std::uint32_t rate;
+		std::uint32_t frame_size;
+		std::uint32_t period_size;
+		std::uint64_t period_time;
+		std::uint64_t count;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Helper functions.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	static inline std::size_t align(std::size_t offset, std::size_t align)
+	{
+		std::size_t extra = offset % align;
+		return offset + (extra > 0 ? align - extra : 0);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Record operation implementation.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	[[ noreturn ]] void RecordOperation::execute(Pipe& pipe, const char* path)
+	{
+		Outlet outlet(pipe);
+		Outlet::Position cursor(outlet.until());
+		Statistics* statistics = pipe.statistics();
+
+		const std::size_t page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+		const std::size_t record_size = sizeof(Preamble) + pipe.period_size();
+		const std::size_t extent_size = align(RECORDING_EXTENT * record_size, page_size);
+
+		File file(path, O_RDWR|O_CREAT|O_EXCL, 0644);
+		std::size_t capacity = page_size + extent_size;
+
+		file.truncate(capacity);
+
+		char* base = reinterpret_cast<char*>(::mmap(nullptr, capacity, PROT_READ|PROT_WRITE, MAP_SHARED, file.descriptor(), 0));
+
+		if (base == MAP_FAILED) {
+			EXC_START(EXC_SYSTEM(errno), RecordingException("[Piper::RecordOperation::execute] Cannot map recording file due to operating system error"));
+		}
+
+		RecordingHeader* header = reinterpret_cast<RecordingHeader*>(base);
+
+		std::memset(base, 0, page_size);
+		header->version = RECORDING_VERSION;
+		std::strncpy(header->format, pipe.format_name(), sizeof(header->format) - 1);
+		header->channels = pipe.channels();
+		header->rate = pipe.rate();
+		header->frame_size = static_cast<std::uint32_t>(pipe.frame_size());
+		header->period_size = static_cast<std::uint32_t>(pipe.period_size());
+		header->period_time = pipe.period_time();
+		header->count = 0;
+
+		std::uint64_t count = 0;
+		std::uint64_t synced = 0;
+
+		try {
+			while (true) {
+				if (outlet.until() == cursor) {
+					outlet.watch();
+					m_callback.on_tick();
+				} else if (outlet.start() <= cursor) {
+					const Preamble& preamble(outlet.preamble(cursor));
+					const Buffer content(outlet.content(cursor));
+
+					if (page_size + (count + 1) * record_size > capacity) {
+						std::size_t grown = capacity + extent_size;
+
+						file.truncate(grown);
+
+						char* moved = reinterpret_cast<char*>(::mremap(base, capacity, grown, MREMAP_MAYMOVE));
+
+						if (moved == MAP_FAILED) {
+							EXC_START(EXC_SYSTEM(errno), RecordingException("[Piper::RecordOperation::execute] Cannot grow recording file mapping due to operating system error"));
+						}
+
+						base = moved;
+						capacity = grown;
+						header = reinterpret_cast<RecordingHeader*>(base);
+					}
+
+					char* slot = base + page_size + count * record_size;
+
+					std::memcpy(slot, &preamble, sizeof(Preamble));
+					std::memcpy(slot + sizeof(Preamble), content.start(), content.size());
+					count += 1;
+					cursor += 1;
+					outlet.mark(cursor);
+
+					if (statistics != nullptr) {
+						statistics->reads.fetch_add(1, std::memory_order_relaxed);
+						statistics->latencies[latency_bucket(now() - preamble.timestamp)].fetch_add(1, std::memory_order_relaxed);
+					}
+
+					if (count - synced >= RECORDING_SYNC_INTERVAL) {
+						header->count = count;
+						::msync(base, page_size + count * record_size, MS_ASYNC);
+						synced = count;
+					}
+
+					m_callback.on_transfer(preamble, content);
+					m_callback.on_tick();
+				} else {
+					if (statistics != nullptr) {
+						statistics->overruns.fetch_add(1, std::memory_order_relaxed);
+					}
+
+					cursor = outlet.until();
+					outlet.mark(cursor);
+				}
+			}
+		} catch (std::exception& ex) {
+			m_callback.on_end();
+			header->count = count;
+			::msync(base, page_size + count * record_size, MS_SYNC);
+			::munmap(base, capacity);
+			file.truncate(page_size + count * record_size);
+			throw;
+		} catch (...) {
+			m_callback.on_end();
+			header->count = count;
+			::msync(base, page_size + count * record_size, MS_SYNC);
+			::munmap(base, capacity);
+			file.truncate(page_size + count * record_size);
+			throw;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Replay operation implementation.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	void ReplayOperation::execute(Pipe& pipe, const char* path)
+	{
+		Inlet inlet(pipe);
+
+		const std::size_t page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+		const std::size_t record_size = sizeof(Preamble) + pipe.period_size();
+
+		File file(path, O_RDONLY);
+
+		file.seek(0, SEEK_END);
+
+		const std::size_t total_size = file.tell();
+
+		if (total_size < page_size) {
+			EXC_START(RecordingCorruptedException("[Piper::ReplayOperation::execute] Cannot replay recording due to truncated header"));
+		}
+
+		char* base = reinterpret_cast<char*>(::mmap(nullptr, total_size, PROT_READ, MAP_SHARED, file.descriptor(), 0));
+
+		if (base == MAP_FAILED) {
+			EXC_START(EXC_SYSTEM(errno), RecordingException("[Piper::ReplayOperation::execute] Cannot map recording file due to operating system error"));
+		}
+
+		const RecordingHeader* header = reinterpret_cast<const RecordingHeader*>(base);
+
+		if (header->version != RECORDING_VERSION) {
+			::munmap(base, total_size);
+			EXC_START(RecordingCorruptedException("[Piper::ReplayOperation::execute] Cannot replay recording due to unsupported version"));
+		} else if (std::strncmp(header->format, pipe.format_name(), sizeof(header->format)) != 0) {
+			::munmap(base, total_size);
+			EXC_START(RecordingCorruptedException("[Piper::ReplayOperation::execute] Cannot replay recording due to mismatched format"));
+		} else if (header->channels != pipe.channels()) {
+			::munmap(base, total_size);
+			EXC_START(RecordingCorruptedException("[Piper::ReplayOperation::execute] Cannot replay recording due to mismatched channels"));
+		} else if (header->rate != pipe.rate()) {
+			::munmap(base, total_size);
+			EXC_START(RecordingCorruptedException("[Piper::ReplayOperation::execute] Cannot replay recording due to mismatched rate"));
+		} else if (header->period_size != pipe.period_size()) {
+			::munmap(base, total_size);
+			EXC_START(RecordingCorruptedException("[Piper::ReplayOperation::execute] Cannot replay recording due to mismatched period size"));
+		} else if (page_size + header->count * record_size > total_size) {
+			::munmap(base, total_size);
+			EXC_START(RecordingCorruptedException("[Piper::ReplayOperation::execute] Cannot replay recording due to truncated content"));
+		}
+
+		const std::uint64_t count = header->count;
+
+		const int advice = ::posix_fadvise(file.descriptor(), 0, 0, POSIX_FADV_SEQUENTIAL);
+
+		if (advice != 0 && advice != EINVAL && advice != ESPIPE) {
+			::munmap(base, total_size);
+			EXC_START(EXC_SYSTEM(advice), RecordingException("[Piper::ReplayOperation::execute] Cannot apply readahead advice to recording file due to operating system error"));
+		} else if (::madvise(base, total_size, MADV_SEQUENTIAL) < 0 && errno != EINVAL) {
+			int error = errno;
+			::munmap(base, total_size);
+			EXC_START(EXC_SYSTEM(error), RecordingException("[Piper::ReplayOperation::execute] Cannot apply sequential advice to recording file due to operating system error"));
+		}
+
+		try {
+			if (count > 0) {
+				const Preamble* first = reinterpret_cast<const Preamble*>(base + page_size);
+				const Timestamp origin = now();
+
+				for (std::uint64_t i = 0; i < count; i++) {
+					const char* slot = base + page_size + i * record_size;
+					const Preamble* source = reinterpret_cast<const Preamble*>(slot);
+					const Timestamp deadline = origin + (source->timestamp - first->timestamp);
+
+					struct timespec limit;
+					limit.tv_sec = deadline / 1000000000;
+					limit.tv_nsec = deadline % 1000000000;
+
+					while (::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &limit, nullptr) == EINTR) {
+						m_callback.on_tick();
+					}
+
+					Inlet::Position position(inlet.start());
+					Preamble& preamble(inlet.preamble(position));
+					Buffer block(inlet.content(position));
+
+					std::memcpy(block.start(), slot + sizeof(Preamble), block.size());
+					preamble.timestamp = now();
+					preamble.flags = source->flags;
+					m_callback.on_transfer(preamble, block);
+					inlet.flush();
+					m_callback.on_tick();
+				}
+			}
+		} catch (std::exception& ex) {
+			m_callback.on_end();
+			::munmap(base, total_size);
+			throw;
+		} catch (...) {
+			m_callback.on_end();
+			::munmap(base, total_size);
+			throw;
+		}
+
+		m_callback.on_end();
+		::munmap(base, total_size);
+	}
+
+}
+
+
@@ -0,0 +1,169 @@
+
+
+#include <exception>
+#include <stdexcept>
+
+#include "buffer.hpp"
+#include "pipe.hpp"
+#include "operation.hpp"
+
+
+#ifndef RECORD_HPP_
+#define RECORD_HPP_
+
+
+namespace Piper
+{
+
+	/**
+	 * Record operation captures blocks flowing through a pipe into an
+	 * append-only recording file.
+	 *
+	 * Implementation Details
+	 * ======================
+	 *
+	 * The recording file starts with a header page describing the audio
+	 * parameters of the recorded pipe, followed by the recorded blocks
+	 * tightly packed, each one carrying the block preamble followed by the
+	 * block content. The layout mirrors the component layout of the
+	 * transport, so a recorded block can be replayed into a compatible pipe
+	 * without any conversion.
+	 *
+	 * The operation maps the recording file into memory and copies each
+	 * readable block straight from the outlet into the mapping, so steady
+	 * state recording costs two memcpys per period and no system call at
+	 * all. The file is grown with ftruncate(2) in large extents and the
+	 * mapping is extended in place, so growth happens well away from the
+	 * period cadence. Every few dozen blocks the block count in the header
+	 * is updated and the dirty range is flushed with an asynchronous
+	 * msync(2), bounding how much a crash can lose.
+	 *
+	 * When the operation falls behind the capacity of the pipe, it is
+	 * resynchronized to the current write position instead of failing, and
+	 * the dropped periods are recorded in the overrun counter of the pipe.
+	 * The recording will contain a timestamp jump over the gap.
+	 *
+	 * When the operation is stopped, the header is finalized, the dirty
+	 * ranges are flushed synchronously and the file is trimmed to its
+	 * exact size, so the trailing extent slack does not persist.
+	 *
+	 * Throughout the operation, appropriate callback will be invoked to
+	 * report the progress. They can be used to stop the operation by
+	 * throwing exceptions.
+	 */
+	class RecordOperation
+	{
+		public:
+
+			/**
+			 * Construct a new record operation.
+			 */
+			explicit RecordOperation(Callback& callback) : m_callback(callback) {}
+
+			/**
+			 * Get the callback used in the record operation.
+			 */
+			const Callback& callback() const noexcept { return m_callback; }
+
+			/**
+			 * Execute the record operation, capturing blocks from the given
+			 * pipe into a new recording file at the given path. Note that any
+			 * exception thrown by the callback will stop the operation and it
+			 * will then be rethrown verbatim.
+			 */
+			void execute(Pipe& pipe, const char* path);
+
+		private:
+
+			/**
+			 * Callback invoked during the operation.
+			 */
+			Callback& m_callback;
+
+	};
+
+	/**
+	 * Replay operation feeds blocks from a recording file back into a pipe.
+	 *
+	 * Implementation Details
+	 * ======================
+	 *
+	 * The operation maps the recording file read-only and validates that
+	 * its header matches the audio parameters of the target pipe. The file
+	 * and the mapping are advised as sequential before the replay starts,
+	 * so the kernel readahead runs ahead of the strictly in-order walk and
+	 * a disk backed recording does not stall the replay on every page
+	 * fault. It then
+	 * walks the recorded blocks in order, and for each block waits until
+	 * the deadline derived from the recorded timestamps before copying the
+	 * block into the inlet and flushing it. The original inter-block
+	 * spacing is therefore reproduced, including any gap left by overruns
+	 * during the recording.
+	 *
+	 * The block timestamps are rewritten on replay because the recorded
+	 * values refer to a past epoch of the monotonic clock; the preamble
+	 * flags are forwarded verbatim, so silent blocks stay marked.
+	 *
+	 * The operation returns normally once every recorded block has been
+	 * replayed.
+	 *
+	 * Throughout the operation, appropriate callback will be invoked to
+	 * report the progress. They can be used to stop the operation by
+	 * throwing exceptions.
+	 */
+	class ReplayOperation
+	{
+		public:
+
+			/**
+			 * Construct a new replay operation.
+			 */
+			explicit ReplayOperation(Callback& callback) : m_callback(callback) {}
+
+			/**
+			 * Get the callback used in the replay operation.
+			 */
+			const Callback& callback() const noexcept { return m_callback; }
+
+			/**
+			 * Execute the replay operation, feeding the given pipe with blocks
+			 * from the recording file at the given path. Note that any
+			 * exception thrown by the callback will stop the operation and it
+			 * will then be rethrown verbatim.
+			 */
+			void execute(Pipe& pipe, const char* path);
+
+		private:
+
+			/**
+			 * Callback invoked during the operation.
+			 */
+			Callback& m_callback;
+
+	};
+
+	/**
+	 * Exception thrown for any recording errors.
+	 */
+	class RecordingException : public std::runtime_error
+	{
+		public:
+			using std::runtime_error::runtime_error;
+	};
+
+	/**
+	 * Exception thrown for corrupted recording files and recording files
+	 * that do not match the target pipe.
+	 */
+	class RecordingCorruptedException : public RecordingException
+	{
+		public:
+			using RecordingException::RecordingException;
+	};
+
+}
+
+
+#endif
+
+
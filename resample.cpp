@@ -0,0 +1,284 @@
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+#include <alsa/asoundlib.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "exception.hpp"
+#include "buffer.hpp"
+#include "convert.hpp"
+#include "resample.hpp"
+
+
+#define EXC_START(...) Support::Exception::start(__VA_ARGS__, "resample.cpp", __LINE__)
+#define EXC_CHAIN(...) Support::Exception::chain(__VA_ARGS__, "resample.cpp", __LINE__);
+
+
+namespace Piper
+{
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Filter parameters and helpers.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	/**
+	 * Number of taps in each phase of the filter bank. Each output sample
+	 * costs one multiply-accumulate of this length.
+	 */
+	static const std::size_t TAPS = 32;
+
+	/**
+	 * Largest factor the reduced rate ratio may contain. The filter bank
+	 * stores one phase per upsampling factor, so the limit bounds the bank
+	 * size; every common audio rate pair reduces far below it.
+	 */
+	static const unsigned int FACTOR_LIMIT = 1024;
+
+	static const double PI = 3.141592653589793238462643;
+
+	/**
+	 * Validate that the given format can be imported into the float domain
+	 * and exported back by the converter stage.
+	 */
+	static snd_pcm_format_t check_format(snd_pcm_format_t format)
+	{
+		if (format == SND_PCM_FORMAT_S16_LE || format == SND_PCM_FORMAT_FLOAT_LE) {
+			return format;
+		} else {
+			EXC_START(UnsupportedResamplingException("[Piper::Resampler::Resampler] Cannot create resampler due to unsupported format"));
+		}
+	}
+
+	/**
+	 * Validate that the given channel count is not zero.
+	 */
+	static unsigned int check_channels(unsigned int channels)
+	{
+		if (channels > 0) {
+			return channels;
+		} else {
+			EXC_START(std::invalid_argument("[Piper::Resampler::Resampler] Cannot create resampler due to invalid channel count"));
+		}
+	}
+
+	/**
+	 * Validate that the given rate is not zero.
+	 */
+	static unsigned int check_rate(unsigned int rate)
+	{
+		if (rate > 0) {
+			return rate;
+		} else {
+			EXC_START(std::invalid_argument("[Piper::Resampler::Resampler] Cannot create resampler due to invalid rate"));
+		}
+	}
+
+	/**
+	 * Calculate the greatest common divisor of the given values.
+	 */
+	static unsigned int divisor(unsigned int a, unsigned int b)
+	{
+		while (b > 0) {
+			unsigned int remainder = a % b;
+			a = b;
+			b = remainder;
+		}
+
+		return a;
+	}
+
+	/**
+	 * Multiply the coefficient window against the sample window and return
+	 * the accumulated sum. On SSE2 capable targets the bulk of the window is
+	 * processed in vector registers and only the tail falls through to the
+	 * scalar loop; on other targets the scalar loop handles the whole
+	 * window.
+	 */
+	static float kernel_dot(const float* coefficients, const float* samples, std::size_t taps)
+	{
+		std::size_t index = 0;
+		float result = 0.0f;
+
+#if defined(__SSE2__)
+		__m128 accumulator = _mm_setzero_ps();
+
+		for (; index + 4 <= taps; index += 4) {
+			accumulator = _mm_add_ps(accumulator, _mm_mul_ps(_mm_loadu_ps(coefficients + index), _mm_loadu_ps(samples + index)));
+		}
+
+		float partial[4];
+		_mm_storeu_ps(partial, accumulator);
+		result = partial[0] + partial[1] + partial[2] + partial[3];
+#endif
+
+		for (; index < taps; index++) {
+			result += coefficients[index] * samples[index];
+		}
+
+		return result;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Resampler implementation.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	Resampler::Resampler(snd_pcm_format_t format, unsigned int channels, unsigned int input_rate, unsigned int output_rate) :
+		m_format(check_format(format)),
+		m_channels(check_channels(channels)),
+		m_input_rate(check_rate(input_rate)),
+		m_output_rate(check_rate(output_rate)),
+		m_factor_up(output_rate / divisor(input_rate, output_rate)),
+		m_factor_down(input_rate / divisor(input_rate, output_rate)),
+		m_import(format, SND_PCM_FORMAT_FLOAT_LE),
+		m_export(SND_PCM_FORMAT_FLOAT_LE, format),
+		m_bank(),
+		m_history(),
+		m_staging(),
+		m_extended(),
+		m_result(),
+		m_phase(0),
+		m_carry(0)
+	{
+		if (m_factor_up > FACTOR_LIMIT || m_factor_down > FACTOR_LIMIT) {
+			EXC_START(UnsupportedResamplingException("[Piper::Resampler::Resampler] Cannot create resampler due to rate pair reducing to excessive factors"));
+		}
+
+		const std::size_t phases = m_factor_up;
+		const std::size_t total = phases * TAPS;
+		const double cutoff = 0.45 / static_cast<double>(std::max(m_factor_up, m_factor_down));
+		const double center = static_cast<double>(total - 1) / 2.0;
+		const double gain = 2.0 * cutoff * static_cast<double>(m_factor_up);
+
+		std::vector<double> prototype(total);
+
+		for (std::size_t i = 0; i < total; i++) {
+			const double position = static_cast<double>(i) - center;
+			const double argument = 2.0 * cutoff * position;
+			const double fraction = static_cast<double>(i) / static_cast<double>(total - 1);
+			const double window = 0.42 - 0.5 * std::cos(2.0 * PI * fraction) + 0.08 * std::cos(4.0 * PI * fraction);
+			const double sinc = (std::fabs(argument) > 0.0 ? std::sin(PI * argument) / (PI * argument) : 1.0);
+
+			prototype[i] = gain * sinc * window;
+		}
+
+		m_bank.resize(total);
+
+		for (std::size_t phase = 0; phase < phases; phase++) {
+			for (std::size_t tap = 0; tap < TAPS; tap++) {
+				m_bank[phase * TAPS + tap] = static_cast<float>(prototype[phase + (TAPS - 1 - tap) * phases]);
+			}
+		}
+
+		m_history.assign(static_cast<std::size_t>(m_channels) * (TAPS - 1), 0.0f);
+	}
+
+	double Resampler::latency() const noexcept
+	{
+		return static_cast<double>(static_cast<std::size_t>(m_factor_up) * TAPS - 1) / (2.0 * static_cast<double>(m_factor_up));
+	}
+
+	std::size_t Resampler::length(std::size_t size) const
+	{
+		const std::size_t frame = m_import.input_sample_size() * m_channels;
+
+		if (size % frame != 0) {
+			EXC_START(std::invalid_argument("[Piper::Resampler::length] Cannot calculate output length due to partial frame in input"));
+		}
+
+		const std::size_t frames = size / frame;
+		const std::size_t maximum = (frames * m_factor_up + m_factor_down - 1) / m_factor_down + 1;
+
+		return maximum * m_export.output_sample_size() * m_channels;
+	}
+
+	std::size_t Resampler::resample(Buffer& output, const Buffer& input)
+	{
+		const std::size_t history = TAPS - 1;
+		const std::size_t frame_in = m_import.input_sample_size() * m_channels;
+		const std::size_t frame_out = m_export.output_sample_size() * m_channels;
+
+		if (input.size() % frame_in != 0) {
+			EXC_START(std::invalid_argument("[Piper::Resampler::resample] Cannot resample buffer due to partial frame in input"));
+		} else if (output.size() < length(input.size())) {
+			EXC_START(std::invalid_argument("[Piper::Resampler::resample] Cannot resample buffer due to insufficient output space"));
+		}
+
+		const std::size_t channels = m_channels;
+		const std::size_t frames = input.size() / frame_in;
+		const std::size_t extent = history + frames;
+
+		m_staging.resize(frames * channels);
+		m_extended.resize(extent * channels);
+		m_result.resize(((frames * m_factor_up) / m_factor_down + 2) * channels);
+
+		Buffer staging(reinterpret_cast<char*>(m_staging.data()), frames * channels * sizeof(float));
+		m_import.convert(staging, input);
+
+		for (std::size_t channel = 0; channel < channels; channel++) {
+			float* extended = m_extended.data() + channel * extent;
+
+			std::memcpy(extended, m_history.data() + channel * history, history * sizeof(float));
+
+			for (std::size_t i = 0; i < frames; i++) {
+				extended[history + i] = m_staging[i * channels + channel];
+			}
+		}
+
+		std::size_t position = m_carry;
+		std::size_t produced = 0;
+		unsigned int phase = m_phase;
+
+		while (position < frames) {
+			const float* bank = m_bank.data() + static_cast<std::size_t>(phase) * TAPS;
+
+			for (std::size_t channel = 0; channel < channels; channel++) {
+				const float* window = m_extended.data() + channel * extent + position;
+
+				m_result[produced * channels + channel] = kernel_dot(bank, window, TAPS);
+			}
+
+			produced += 1;
+			phase += m_factor_down;
+			position += phase / m_factor_up;
+			phase %= m_factor_up;
+		}
+
+		m_phase = phase;
+		m_carry = position - frames;
+
+		for (std::size_t channel = 0; channel < channels; channel++) {
+			std::memcpy(m_history.data() + channel * history, m_extended.data() + channel * extent + frames, history * sizeof(float));
+		}
+
+		if (produced > 0) {
+			Buffer result(reinterpret_cast<char*>(m_result.data()), produced * channels * sizeof(float));
+
+			m_export.convert(output, result);
+		}
+
+		return produced * frame_out;
+	}
+
+	void Resampler::reset() noexcept
+	{
+		std::fill(m_history.begin(), m_history.end(), 0.0f);
+		m_phase = 0;
+		m_carry = 0;
+	}
+
+}
+
@@ -0,0 +1,233 @@
+
+
+#include <cstddef>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+#include <alsa/asoundlib.h>
+
+#include "buffer.hpp"
+#include "convert.hpp"
+
+
+#ifndef RESAMPLE_HPP_
+#define RESAMPLE_HPP_
+
+
+namespace Piper
+{
+
+	/**
+	 * Resampler implements a sample rate conversion stage between a pipe and
+	 * a device.
+	 *
+	 * Pipes are created with a single fixed sample rate and normally the
+	 * devices have to match it exactly. When they cannot, a resampler can be
+	 * placed between the two: a drain client would resample each block from
+	 * the outlet into the device rate buffer handed to the playback device,
+	 * and a feed client would resample data from the device into the inlet
+	 * block. Keeping the stage inside the pipeline avoids the extra staging
+	 * buffer and scalar conversion pass of an external plug layer, and makes
+	 * its latency contribution explicit via the latency member function.
+	 *
+	 * Implementation Details
+	 * ======================
+	 *
+	 * The resampler implements polyphase filtering. The rate pair is reduced
+	 * to a ratio of two coprime factors and a windowed sinc lowpass filter
+	 * is designed once at construction for the common upsampled rate; its
+	 * coefficients are split into one phase per output offset, stored in
+	 * tap-reversed order so that each output sample reduces to a contiguous
+	 * multiply-accumulate over the input window. The kernels process each
+	 * window with SSE2 vector code where the target supports it, falling
+	 * back to portable scalar code elsewhere.
+	 *
+	 * Samples are filtered in the float domain. Input periods are imported
+	 * into a deinterleaved float workspace through the converter stage and
+	 * results are exported back the same way, so the resampler accepts the
+	 * formats the converter can move to and from float. The workspace also
+	 * carries the filter history between calls, which means periods can be
+	 * fed one at a time and the output stays continuous across them.
+	 */
+	class Resampler
+	{
+		public:
+
+			/**
+			 * Construct a new resampler between the given input and output
+			 * rates for interleaved data in the given format. Throws an
+			 * unsupported resampling exception when the format cannot be
+			 * imported into the float domain or when the rate pair reduces
+			 * to factors too large for a precomputed filter bank.
+			 */
+			explicit Resampler(snd_pcm_format_t format, unsigned int channels, unsigned int input_rate, unsigned int output_rate);
+
+			/**
+			 * Return the sample format of the resampler.
+			 */
+			snd_pcm_format_t format() const noexcept { return m_format; }
+
+			/**
+			 * Return the channel count of the resampler.
+			 */
+			unsigned int channels() const noexcept { return m_channels; }
+
+			/**
+			 * Return the input rate of the resampler.
+			 */
+			unsigned int input_rate() const noexcept { return m_input_rate; }
+
+			/**
+			 * Return the output rate of the resampler.
+			 */
+			unsigned int output_rate() const noexcept { return m_output_rate; }
+
+			/**
+			 * Return the group delay of the resampler filter in input frames.
+			 * Output produced by the resampler lags the input by this amount,
+			 * so a client can account for the stage when sizing the overall
+			 * pipeline latency.
+			 */
+			double latency() const noexcept;
+
+			/**
+			 * Return the amount of output space in bytes sufficient to
+			 * resample input of the given size. Throws an invalid argument
+			 * exception when the given size contains a partial frame.
+			 */
+			std::size_t length(std::size_t size) const;
+
+			/**
+			 * Resample every frame in the input buffer, store the results in
+			 * the output buffer and return the number of bytes stored. The
+			 * output buffer should provide the space reported by the length
+			 * member function. Throws an invalid argument exception when the
+			 * input buffer contains a partial frame or when the output buffer
+			 * is too small for the resampled data.
+			 */
+			std::size_t resample(Buffer& output, const Buffer& input);
+
+			/**
+			 * Discard the filter history and phase of the resampler. It
+			 * should be called when the input stream is no longer continuous,
+			 * for example after resynchronization over an overrun.
+			 */
+			void reset() noexcept;
+
+		private:
+
+			/**
+			 * Sample format processed by the resampler.
+			 */
+			snd_pcm_format_t m_format;
+
+			/**
+			 * Number of channels in a frame.
+			 */
+			unsigned int m_channels;
+
+			/**
+			 * Input rate of the resampler.
+			 */
+			unsigned int m_input_rate;
+
+			/**
+			 * Output rate of the resampler.
+			 */
+			unsigned int m_output_rate;
+
+			/**
+			 * Upsampling factor of the reduced rate ratio. It doubles as the
+			 * number of phases in the filter bank.
+			 */
+			unsigned int m_factor_up;
+
+			/**
+			 * Downsampling factor of the reduced rate ratio.
+			 */
+			unsigned int m_factor_down;
+
+			/**
+			 * Converter importing input periods into the float workspace.
+			 */
+			Converter m_import;
+
+			/**
+			 * Converter exporting filtered results back to the sample format.
+			 */
+			Converter m_export;
+
+			/**
+			 * Filter bank of the resampler. It stores one phase per output
+			 * offset, each phase holding its taps contiguously in reversed
+			 * order so that the multiply-accumulate runs forward over the
+			 * input window.
+			 */
+			std::vector<float> m_bank;
+
+			/**
+			 * Filter history of each channel carried between calls. It holds
+			 * the trailing input frames of the previous period, deinterleaved
+			 * per channel.
+			 */
+			std::vector<float> m_history;
+
+			/**
+			 * Workspace holding the imported input period in interleaved
+			 * float frames. It grows to the largest period seen and is then
+			 * reused without further allocation.
+			 */
+			std::vector<float> m_staging;
+
+			/**
+			 * Workspace holding the deinterleaved input of each channel with
+			 * the filter history prepended. It grows to the largest period
+			 * seen and is then reused without further allocation.
+			 */
+			std::vector<float> m_extended;
+
+			/**
+			 * Workspace holding the filtered output in interleaved float
+			 * frames before export. It grows to the largest period seen and
+			 * is then reused without further allocation.
+			 */
+			std::vector<float> m_result;
+
+			/**
+			 * Phase of the next output frame within the filter bank.
+			 */
+			unsigned int m_phase;
+
+			/**
+			 * Input frames of the next period already consumed by the phase
+			 * accumulator at the end of the previous period.
+			 */
+			std::size_t m_carry;
+
+	};
+
+	/**
+	 * Exception thrown for any resampler errors.
+	 */
+	class ResampleException : public std::runtime_error
+	{
+		public:
+			using std::runtime_error::runtime_error;
+	};
+
+	/**
+	 * Exception thrown when resampling between the requested rates or over
+	 * the requested format is not implemented by the resampler.
+	 */
+	class UnsupportedResamplingException : public ResampleException
+	{
+		public:
+			using ResampleException::ResampleException;
+	};
+
+}
+
+
+#endif
+
@@ -0,0 +1,239 @@
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+#include "exception.hpp"
+#include "timestamp.hpp"
+#include "arena.hpp"
+#include "buffer.hpp"
+#include "pipe.hpp"
+#include "device.hpp"
+#include "tokenbucket.hpp"
+#include "route.hpp"
+
+
+#define EXC_START(...) Support::Exception::start(__VA_ARGS__, "route.cpp", __LINE__)
+#define EXC_CHAIN(...) Support::Exception::chain(__VA_ARGS__, "route.cpp", __LINE__);
+#define EXC_SYSTEM(err) std::system_error(err, std::system_category(), strerror(err))
+
+
+namespace Piper
+{
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Router implementation.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	void Router::add_feed(const char* path, CaptureDevice& device)
+	{
+		Route route;
+
+		route.type = FEED;
+		route.pipe.reset(new Pipe(path));
+		route.capture = &device;
+
+		m_routes.push_back(std::move(route));
+	}
+
+	void Router::add_drain(const char* path, PlaybackDevice& device)
+	{
+		Route route;
+
+		route.type = DRAIN;
+		route.pipe.reset(new Pipe(path));
+		route.playback = &device;
+
+		m_routes.push_back(std::move(route));
+	}
+
+	void Router::step_feed(Route& route)
+	{
+		route.bucket->try_refill(0);
+
+		while (route.bucket->tokens() > 0) {
+			Buffer content(route.inlet->content(route.cursor));
+			Buffer slice(content.tail(route.remainder));
+			Destination destination(slice);
+
+			route.capture->try_read(destination, 0);
+
+			if (destination.remainder() == route.remainder) {
+				break;
+			}
+
+			route.remainder = destination.remainder();
+
+			if (route.remainder == 0) {
+				Preamble& preamble(route.inlet->preamble(route.cursor));
+
+				preamble.timestamp = now();
+				preamble.flags = (is_silent(content) ? Preamble::FLAG_SILENCE : 0);
+				m_callback.on_transfer(preamble, content);
+				route.inlet->flush();
+				route.bucket->spend(1);
+				route.cursor += 1;
+				route.remainder = content.size();
+			}
+		}
+	}
+
+	void Router::step_drain(Route& route)
+	{
+		route.bucket->try_refill(0);
+
+		while (route.bucket->tokens() > 0) {
+			if (route.outlet->until() == route.cursor) {
+				break;
+			} else if (route.outlet->start() > route.cursor) {
+				if (route.statistics != nullptr) {
+					route.statistics->overruns.fetch_add(1, std::memory_order_relaxed);
+				}
+
+				route.cursor = route.outlet->until();
+				route.remainder = route.pipe->period_size();
+				route.outlet->mark(route.cursor);
+				break;
+			}
+
+			const Preamble& preamble(route.outlet->preamble(route.cursor));
+			const Buffer content(route.outlet->content(route.cursor));
+			const Buffer block((preamble.flags & Preamble::FLAG_SILENCE) != 0 ? Buffer(route.silence, route.pipe->period_size()) : content);
+			const Buffer slice(block.tail(route.remainder));
+			Source source(slice);
+
+			route.playback->try_write(source, 0);
+
+			if (source.remainder() == route.remainder) {
+				break;
+			}
+
+			route.remainder = source.remainder();
+
+			if (route.remainder == 0) {
+				if (route.statistics != nullptr) {
+					route.statistics->reads.fetch_add(1, std::memory_order_relaxed);
+					route.statistics->latencies[latency_bucket(now() - preamble.timestamp)].fetch_add(1, std::memory_order_relaxed);
+				}
+
+				m_callback.on_transfer(preamble, content);
+				route.bucket->spend(1);
+				route.cursor += 1;
+				route.remainder = content.size();
+				route.outlet->mark(route.cursor);
+			}
+		}
+	}
+
+	[[ noreturn ]] void Router::execute()
+	{
+		if (m_routes.empty()) {
+			EXC_START(std::invalid_argument("[Piper::Router::execute] Cannot execute router due to missing pairings"));
+		}
+
+		int epoll = ::epoll_create1(0);
+
+		if (epoll < 0) {
+			EXC_START(EXC_SYSTEM(errno), RouterException("[Piper::Router::execute] Cannot execute router due to operating system error"));
+		}
+
+		try {
+			const Timestamp origin = now();
+
+			for (std::size_t i = 0; i < m_routes.size(); i++) {
+				Route& route(m_routes[i]);
+
+				route.bucket.reset(new TokenBucket(10, 1, route.pipe->period_time()));
+				route.statistics = route.pipe->statistics();
+				route.remainder = route.pipe->period_size();
+
+				if (route.type == FEED) {
+					route.inlet.reset(new Inlet(*route.pipe));
+					route.cursor = route.inlet->start();
+					route.capture->configure(*route.pipe);
+					route.capture->start();
+					m_callback.on_begin_feed(*route.pipe, *route.capture);
+				} else {
+					route.outlet.reset(new Outlet(*route.pipe));
+					route.cursor = route.outlet->until();
+					route.arena.clear();
+					route.arena.reserve(route.pipe->period_size());
+					route.silence = route.arena.allocate(route.pipe->period_size());
+					std::memset(route.silence, 0, route.pipe->period_size());
+					route.playback->configure(*route.pipe, 1);
+					route.playback->start();
+					m_callback.on_begin_drain(*route.pipe, *route.playback);
+				}
+
+				route.bucket->start(origin, m_slack);
+
+				struct epoll_event event;
+				std::memset(&event, 0, sizeof(event));
+				event.events = EPOLLIN;
+				event.data.u32 = static_cast<std::uint32_t>(i);
+
+				if (::epoll_ctl(epoll, EPOLL_CTL_ADD, route.bucket->timer().descriptor(), &event) < 0) {
+					EXC_START(EXC_SYSTEM(errno), RouterException("[Piper::Router::execute] Cannot execute router due to operating system error"));
+				}
+			}
+
+			while (true) {
+				struct epoll_event events[16];
+				int count = ::epoll_wait(epoll, events, 16, -1);
+
+				if (count < 0 && errno != EINTR) {
+					EXC_START(EXC_SYSTEM(errno), RouterException("[Piper::Router::execute] Cannot execute router due to operating system error"));
+				}
+
+				for (int i = 0; i < count; i++) {
+					Route& route(m_routes[events[i].data.u32]);
+
+					if (route.type == FEED) {
+						step_feed(route);
+					} else {
+						step_drain(route);
+					}
+				}
+
+				m_callback.on_tick();
+			}
+		} catch (std::exception& ex) {
+			m_callback.on_end();
+
+			for (Route& route : m_routes) {
+				if (route.bucket != nullptr) {
+					route.bucket->stop();
+				}
+
+				if (route.type == FEED && route.capture != nullptr) {
+					route.capture->stop();
+				} else if (route.type == DRAIN && route.playback != nullptr) {
+					route.playback->stop();
+				}
+
+				route.inlet.reset();
+				route.outlet.reset();
+				route.bucket.reset();
+			}
+
+			::close(epoll);
+			throw;
+		}
+	}
+
+}
+
+
@@ -0,0 +1,178 @@
+
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "timestamp.hpp"
+#include "arena.hpp"
+#include "buffer.hpp"
+#include "pipe.hpp"
+#include "device.hpp"
+#include "tokenbucket.hpp"
+#include "operation.hpp"
+
+
+#ifndef ROUTE_HPP_
+#define ROUTE_HPP_
+
+
+namespace Piper
+{
+
+	/**
+	 * Router services multiple pipe and device pairings from a single
+	 * process.
+	 *
+	 * Implementation Details
+	 * ======================
+	 *
+	 * Each pairing added to the router contributes the timer descriptor of
+	 * its token bucket to a single epoll instance. The execute method runs
+	 * an event loop over the instance and steps the pairing whose timer
+	 * fired. A step refills the token bucket and then moves periods between
+	 * the pipe and the device with non-blocking device calls, carrying any
+	 * partial transfer over to the next step, so a single slow device never
+	 * stalls the other pairings.
+	 *
+	 * Unlike the standalone drain operation, a drain pairing that falls
+	 * behind the pipe resynchronizes to the current write position instead
+	 * of failing, so a single overrun cannot tear down the whole process.
+	 *
+	 * Throughout the operation, appropriate callback will be invoked to
+	 * report the progress. They can be used to stop the operation by
+	 * throwing exceptions.
+	 */
+	class Router
+	{
+		public:
+
+			/**
+			 * Type code for feed pairings.
+			 */
+			const static int FEED = 1;
+
+			/**
+			 * Type code for drain pairings.
+			 */
+			const static int DRAIN = 2;
+
+			/**
+			 * Construct a new router. The optional slack controls wakeup
+			 * coalescing: the token bucket timers of all pairings are started
+			 * in deadline mode against a common origin and their first expiry
+			 * may be deferred by up to the slack, so that pairings with nearby
+			 * deadlines wake the event loop together. The slack has to be
+			 * smaller than the period time of every routed pipe.
+			 */
+			explicit Router(Callback& callback, Duration slack = 0) : m_callback(callback), m_slack(slack), m_routes() {}
+
+			/**
+			 * Get the callback used in the router.
+			 */
+			const Callback& callback() const noexcept { return m_callback; }
+
+			/**
+			 * Get the wakeup coalescing slack of the router.
+			 */
+			Duration slack() const noexcept { return m_slack; }
+
+			/**
+			 * Add a pairing that feeds the pipe at the given path from the given
+			 * capture device. The pipe is opened immediately so that invalid
+			 * paths are reported at setup time. The device should outlive the
+			 * router.
+			 */
+			void add_feed(const char* path, CaptureDevice& device);
+
+			/**
+			 * Add a pairing that drains the pipe at the given path to the given
+			 * playback device. The pipe is opened immediately so that invalid
+			 * paths are reported at setup time. The device should outlive the
+			 * router.
+			 */
+			void add_drain(const char* path, PlaybackDevice& device);
+
+			/**
+			 * Execute the router over all added pairings. Note that any
+			 * exception thrown by the callback will stop the router and it will
+			 * then be rethrown verbatim.
+			 */
+			void execute();
+
+			Router(const Router& router) = delete;
+			Router(Router&& router) = delete;
+			Router& operator=(const Router& router) = delete;
+			Router& operator=(Router&& router) = delete;
+
+		private:
+
+			/**
+			 * Route stores the state of a single pipe and device pairing,
+			 * including the transfer cursor and the remaining byte count of the
+			 * period currently in flight.
+			 */
+			struct Route
+			{
+				int type = 0;
+				std::unique_ptr<Pipe> pipe;
+				CaptureDevice* capture = nullptr;
+				PlaybackDevice* playback = nullptr;
+				std::unique_ptr<Inlet> inlet;
+				std::unique_ptr<Outlet> outlet;
+				std::unique_ptr<TokenBucket> bucket;
+				Statistics* statistics = nullptr;
+				Transport::Position cursor = 0;
+				std::size_t remainder = 0;
+				Support::Arena arena;
+				char* silence = nullptr;
+			};
+
+			/**
+			 * Step a feed pairing by refilling its token bucket and moving due
+			 * periods from the capture device into the pipe.
+			 */
+			void step_feed(Route& route);
+
+			/**
+			 * Step a drain pairing by refilling its token bucket and moving due
+			 * periods from the pipe to the playback device.
+			 */
+			void step_drain(Route& route);
+
+			/**
+			 * Callback invoked during the operation.
+			 */
+			Callback& m_callback;
+
+			/**
+			 * Wakeup coalescing slack applied to the pairing timers.
+			 */
+			Duration m_slack;
+
+			/**
+			 * Pairings serviced by the router.
+			 */
+			std::vector<Route> m_routes;
+
+	};
+
+	/**
+	 * Exception thrown when the router cannot operate its event loop.
+	 */
+	class RouterException : public std::runtime_error
+	{
+		public:
+			using std::runtime_error::runtime_error;
+	};
+
+}
+
+
+#endif
+
+
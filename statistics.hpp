@@ -2,6 +2,8 @@
 
 #include <cfloat>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 
 
 #ifndef STATISTICS_HPP_
@@ -46,6 +48,19 @@ namespace Support
 					}
 				}
 
+				/**
+				 * Update the counter with a block of samples and return the updated
+				 * value. The result is the same as consuming each sample in order.
+				 */
+				double consume(const double* samples, std::size_t count) noexcept
+				{
+					for (std::size_t i = 0; i < count; i++) {
+						consume(samples[i]);
+					}
+
+					return m_value;
+				}
+
 			private:
 
 				double m_value;
@@ -86,6 +101,20 @@ namespace Support
 					}
 				}
 
+				/**
+				 * Update the underlying counter with a block of samples and return
+				 * the updated value. The result is the same as consuming each sample
+				 * in order.
+				 */
+				double consume(const double* samples, std::size_t count) noexcept
+				{
+					for (std::size_t i = 0; i < count; i++) {
+						consume(samples[i]);
+					}
+
+					return m_child.value();
+				}
+
 			private:
 
 				T m_child;
@@ -126,6 +155,20 @@ namespace Support
 					}
 				}
 
+				/**
+				 * Update the underlying counter with a block of samples and return
+				 * the updated value. The result is the same as consuming each sample
+				 * in order.
+				 */
+				double consume(const double* samples, std::size_t count) noexcept
+				{
+					for (std::size_t i = 0; i < count; i++) {
+						consume(samples[i]);
+					}
+
+					return m_child.value();
+				}
+
 			private:
 
 				T m_child;
@@ -165,6 +208,20 @@ namespace Support
 					}
 				}
 
+				/**
+				 * Update the underlying counter with a block of samples and return
+				 * the updated value. The result is the same as consuming each sample
+				 * in order.
+				 */
+				double consume(const double* samples, std::size_t count) noexcept
+				{
+					for (std::size_t i = 0; i < count; i++) {
+						consume(samples[i]);
+					}
+
+					return m_child.value();
+				}
+
 			private:
 
 				T m_child;
@@ -208,6 +265,20 @@ namespace Support
 					}
 				}
 
+				/**
+				 * Update the underlying counter with a block of samples and return
+				 * the updated value. The result is the same as consuming each sample
+				 * in order.
+				 */
+				double consume(const double* samples, std::size_t count) noexcept
+				{
+					for (std::size_t i = 0; i < count; i++) {
+						consume(samples[i]);
+					}
+
+					return m_child.value();
+				}
+
 			private:
 
 				T m_child;
@@ -215,6 +286,154 @@ namespace Support
 
 		};
 
+		/**
+		 * Counter for estimating quantiles of the sample stream in fixed
+		 * memory. Samples are recorded into a histogram whose buckets cover
+		 * successive powers of two, so a sample costs a single bucket
+		 * increment regardless of how many samples were seen before, and no
+		 * sample is ever stored. Quantiles are read back by walking the
+		 * cumulative bucket counts and interpolating linearly within the
+		 * matching bucket, which bounds the relative error of an estimate by
+		 * the bucket width.
+		 *
+		 * The counter exposes the same value/consume interface as the other
+		 * counters, so it composes with the existing transformers; the value
+		 * member function reports the quantile configured at construction,
+		 * while the estimate member function can read any other quantile from
+		 * the same histogram.
+		 */
+		class Quantile
+		{
+			public:
+
+				/**
+				 * Construct a custom counter estimating the given quantile. The
+				 * quantile is expressed as a fraction, like 0.99 for p99.
+				 */
+				explicit Quantile(double quantile) : m_quantile(quantile), m_count(0), m_buckets{}
+				{
+					// do nothing
+				}
+
+				/**
+				 * Return the current estimate of the configured quantile.
+				 */
+				double value() const noexcept
+				{
+					return estimate(m_quantile);
+				}
+
+				/**
+				 * Return the estimate of the given quantile over the recorded
+				 * samples. Returns NaN when no sample has been recorded yet.
+				 */
+				double estimate(double quantile) const noexcept
+				{
+					if (m_count == 0) {
+						return std::nan("1");
+					}
+
+					double rank = quantile * static_cast<double>(m_count);
+					double cumulative = 0.0;
+
+					for (std::size_t index = 0; index < BUCKETS; index++) {
+						if (m_buckets[index] > 0) {
+							double next = cumulative + static_cast<double>(m_buckets[index]);
+
+							if (next >= rank) {
+								double lower = bound(index);
+								double upper = bound(index + 1);
+								double fraction = (rank - cumulative) / static_cast<double>(m_buckets[index]);
+								return lower + fraction * (upper - lower);
+							}
+
+							cumulative = next;
+						}
+					}
+
+					return bound(BUCKETS);
+				}
+
+				/**
+				 * Update the counter with next sample and return the updated value.
+				 */
+				double consume(double sample) noexcept
+				{
+					m_buckets[bucket(sample)] += 1;
+					m_count += 1;
+					return value();
+				}
+
+				/**
+				 * Update the counter with a block of samples and return the updated
+				 * value. The whole block is reduced into the histogram before the
+				 * estimate is recomputed once.
+				 */
+				double consume(const double* samples, std::size_t count) noexcept
+				{
+					for (std::size_t i = 0; i < count; i++) {
+						m_buckets[bucket(samples[i])] += 1;
+					}
+
+					m_count += count;
+					return value();
+				}
+
+			private:
+
+				/**
+				 * Number of buckets in the histogram. Each bucket covers one
+				 * power of two, so the histogram spans samples between 2^-48
+				 * and 2^47; samples outside the span are clamped into the
+				 * first or last bucket.
+				 */
+				static const std::size_t BUCKETS = 96;
+
+				/**
+				 * Bucket index of the samples between 0.5 and 1.
+				 */
+				static const int OFFSET = 48;
+
+				/**
+				 * Return the histogram bucket covering the given sample. Samples
+				 * that are not positive, including NaN, fall into the first
+				 * bucket; infinite samples fall into the last one.
+				 */
+				static std::size_t bucket(double sample) noexcept
+				{
+					int exponent = 0;
+
+					if (!(sample > 0.0)) {
+						return 0;
+					} else if (!std::isfinite(sample)) {
+						return BUCKETS - 1;
+					}
+
+					std::frexp(sample, &exponent);
+
+					if (exponent < 1 - OFFSET) {
+						return 0;
+					} else if (exponent >= static_cast<int>(BUCKETS) - OFFSET) {
+						return BUCKETS - 1;
+					} else {
+						return static_cast<std::size_t>(exponent + OFFSET);
+					}
+				}
+
+				/**
+				 * Return the lower bound of the given bucket.
+				 */
+				static double bound(std::size_t index) noexcept
+				{
+					return std::ldexp(1.0, static_cast<int>(index) - OFFSET - 1);
+				}
+
+				double m_quantile;
+				std::uint64_t m_count;
+				std::uint64_t m_buckets[BUCKETS];
+
+		};
+
 		inline Average make_average() { return Average(1); }
 		inline Average make_average(int N) { return Average(N); }
 		template<typename T> inline Filter<T> make_filter(T child) { return Filter<T>(child, DBL_MIN, DBL_MAX); }
@@ -223,6 +442,8 @@ namespace Support
 		template<typename T> inline Divergence<T> make_divergence(T child) { return Divergence<T>(child, 0.0); }
 		template<typename T> inline Divergence<T> make_divergence(T child, double reference) { return Divergence<T>(child, reference); }
 		template<typename T> inline Delta<T> make_delta(T child) { return Delta<T>(child); }
+		inline Quantile make_quantile() { return Quantile(0.99); }
+		inline Quantile make_quantile(double quantile) { return Quantile(quantile); }
 
 	}
 
@@ -82,6 +82,80 @@ namespace Piper
 		}
 	}
 
+	void Timer::start(Timestamp origin, Duration slack)
+	{
+		if (slack >= m_period) {
+			EXC_START(std::invalid_argument("[Piper::Timer::start] Cannot start timer due to slack not smaller than period"));
+		}
+
+		const Timestamp period = static_cast<Timestamp>(m_period);
+		const Timestamp current = now();
+		Timestamp expiry = origin;
+
+		if (expiry <= current) {
+			expiry = origin + ((current - origin) / period + 1) * period;
+		}
+
+		if (slack > 0) {
+			const Timestamp step = static_cast<Timestamp>(slack);
+			expiry = ((expiry + step - 1) / step) * step;
+		}
+
+		struct itimerspec interval;
+		interval.it_value.tv_sec = expiry / 1000000000;
+		interval.it_value.tv_nsec = expiry % 1000000000;
+		interval.it_interval.tv_sec = static_cast<time_t>(m_period / 1000000000);
+		interval.it_interval.tv_nsec = static_cast<long>(m_period % 1000000000);
+
+		if (::timerfd_settime(m_descriptor, TFD_TIMER_ABSTIME, &interval, nullptr) >= 0) {
+			m_ticks = 0;
+		} else {
+			switch (errno) {
+				case EBADF: EXC_START(std::logic_error("[Piper::Timer::start] Cannot start timer due to stale descriptor"));
+				case EINVAL: EXC_START(std::logic_error("[Piper::Timer::start] Cannot start timer due to stale descriptor"));
+				case EFAULT: EXC_START(std::logic_error("[Piper::Timer::start] Cannot start timer due to unexpected error on itimerspec pointers"));
+				default: EXC_START(EXC_SYSTEM(errno), TimerException("[Piper::Timer::start] Cannot start timer due to operating system error"));
+			}
+		}
+	}
+
+	void Timer::adjust(Duration period)
+	{
+		if (period == 0) {
+			EXC_START(std::invalid_argument("[Piper::Timer::adjust] Cannot adjust timer due to invalid period"));
+		}
+
+		struct itimerspec running;
+
+		if (::timerfd_gettime(m_descriptor, &running) < 0) {
+			switch (errno) {
+				case EBADF: EXC_START(std::logic_error("[Piper::Timer::adjust] Cannot adjust timer due to stale descriptor"));
+				case EINVAL: EXC_START(std::logic_error("[Piper::Timer::adjust] Cannot adjust timer due to stale descriptor"));
+				case EFAULT: EXC_START(std::logic_error("[Piper::Timer::adjust] Cannot adjust timer due to unexpected error on itimerspec pointers"));
+				default: EXC_START(EXC_SYSTEM(errno), TimerException("[Piper::Timer::adjust] Cannot adjust timer due to operating system error"));
+			}
+		}
+
+		m_period = period;
+
+		if (running.it_value.tv_sec != 0 || running.it_value.tv_nsec != 0) {
+			struct itimerspec interval;
+			interval.it_value.tv_sec = running.it_value.tv_sec;
+			interval.it_value.tv_nsec = running.it_value.tv_nsec;
+			interval.it_interval.tv_sec = static_cast<time_t>(m_period / 1000000000);
+			interval.it_interval.tv_nsec = static_cast<long>(m_period % 1000000000);
+
+			if (::timerfd_settime(m_descriptor, 0, &interval, nullptr) < 0) {
+				switch (errno) {
+					case EBADF: EXC_START(std::logic_error("[Piper::Timer::adjust] Cannot adjust timer due to stale descriptor"));
+					case EINVAL: EXC_START(std::logic_error("[Piper::Timer::adjust] Cannot adjust timer due to stale descriptor"));
+					case EFAULT: EXC_START(std::logic_error("[Piper::Timer::adjust] Cannot adjust timer due to unexpected error on itimerspec pointers"));
+					default: EXC_START(EXC_SYSTEM(errno), TimerException("[Piper::Timer::adjust] Cannot adjust timer due to operating system error"));
+				}
+			}
+		}
+	}
+
 	void Timer::stop()
 	{
 		struct itimerspec interval;
@@ -78,6 +78,32 @@ namespace Piper
 			 */
 			void start();
 
+			/**
+			 * Start the timer in deadline mode and clear accumulated ticks. In
+			 * deadline mode the timer is programmed with an absolute expiry
+			 * time, so each tick lands on an exact multiple of the period after
+			 * the given origin timestamp instead of drifting with wakeup
+			 * latency. The first expiry may additionally be deferred by up to
+			 * the given slack to the next multiple of the slack, so that timers
+			 * of nearby streams expire together and their wakeups coalesce.
+			 * Throws invalid argument exception when the slack is not smaller
+			 * than the period; throws timer exception when the timer cannot be
+			 * started.
+			 */
+			void start(Timestamp origin, Duration slack = 0);
+
+			/**
+			 * Adjust the period of the timer to the given duration. When the
+			 * timer is running, the pending expiry is kept on its original
+			 * schedule and only subsequent ticks follow the new period, so an
+			 * adjustment never causes a tick to be lost or duplicated; the
+			 * accumulated ticks are preserved as well. When the timer is
+			 * stopped, only the period is updated and the timer stays stopped.
+			 * Throws invalid argument exception when the period is zero; throws
+			 * timer exception when the timer cannot be re-armed.
+			 */
+			void adjust(Duration period);
+
 			/**
 			 * Stop the timer and clear accumulated ticks. Throws timer exception
 			 * when the timer cannot be stopped.
@@ -54,6 +54,33 @@ namespace Piper
 		}
 	}
 
+	void TokenBucket::start(Timestamp origin, Duration slack)
+	{
+		try {
+			m_timer.start(origin, slack);
+			m_tokens = 0;
+		} catch (std::invalid_argument& ex) {
+			EXC_CHAIN(std::invalid_argument("[Piper::TokenBucket::start] Cannot start token bucket due to invalid slack"));
+		} catch (std::logic_error& ex) {
+			EXC_CHAIN(std::logic_error("[Piper::TokenBucket::start] Cannot start token bucket due to logic error in underlying component"));
+		} catch (TimerException& ex) {
+			EXC_CHAIN(TokenBucketException("[Piper::TokenBucket::start] Cannot start token bucket due to timer error"));
+		}
+	}
+
+	void TokenBucket::adjust(Duration period)
+	{
+		try {
+			m_timer.adjust(period);
+		} catch (std::invalid_argument& ex) {
+			EXC_CHAIN(std::invalid_argument("[Piper::TokenBucket::adjust] Cannot adjust token bucket due to invalid period"));
+		} catch (std::logic_error& ex) {
+			EXC_CHAIN(std::logic_error("[Piper::TokenBucket::adjust] Cannot adjust token bucket due to logic error in underlying component"));
+		} catch (TimerException& ex) {
+			EXC_CHAIN(TokenBucketException("[Piper::TokenBucket::adjust] Cannot adjust token bucket due to timer error"));
+		}
+	}
+
 	void TokenBucket::stop()
 	{
 		try {
@@ -83,6 +83,27 @@ namespace Piper
 			 */
 			void start();
 
+			/**
+			 * Start the token bucket with the associated timer in deadline mode,
+			 * where refills land on exact multiples of the period after the given
+			 * origin timestamp and the first refill may be deferred by up to the
+			 * given slack so that wakeups of nearby streams coalesce. Throws
+			 * invalid argument exception when the slack is not smaller than the
+			 * period; throws timer exception when the timer cannot be started.
+			 */
+			void start(Timestamp origin, Duration slack = 0);
+
+			/**
+			 * Adjust the refill period of the token bucket to the given duration.
+			 * The adjustment takes effect from the next refill onwards and does
+			 * not disturb the pending refill or the tokens already in the bucket,
+			 * so it can be applied while the bucket is running to trim the flow
+			 * rate against an external clock. Throws invalid argument exception
+			 * when the period is zero; throws token bucket exception when the
+			 * underlying timer cannot be adjusted.
+			 */
+			void adjust(Duration period);
+
 			/**
 			 * Stop the token bucket and the associated timer. Throws timer exception
 			 * when the timer cannot be stopped.
@@ -8,6 +8,7 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include <exception>
 #include <memory>
@@ -16,9 +17,13 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <time.h>
 #include <unistd.h>
+#include <linux/fs.h>
+#include <linux/futex.h>
 #include <sys/mman.h>
+#include <sys/syscall.h>
 
 #include "exception.hpp"
 #include "buffer.hpp"
@@ -55,13 +60,70 @@ namespace Piper
 		return offset + (extra > 0 ? align - extra : 0);
 	}
 
+	/**
+	 * Return a pointer to the futex word embedded in the write counter. The
+	 * futex interface operates on 32-bit words only, so the helper locates
+	 * the low order word of the 64-bit counter which receives every update
+	 * to the counter.
+	 */
+	static inline const std::uint32_t* futex_word(const Backer::WriteCounter& writes) noexcept
+	{
+		static_assert(sizeof(Backer::WriteCounter) == 2 * sizeof(std::uint32_t), "incorrect layout for write counter");
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		return reinterpret_cast<const std::uint32_t*>(reinterpret_cast<const char*>(&writes) + sizeof(std::uint32_t));
+#else
+		return reinterpret_cast<const std::uint32_t*>(&writes);
+#endif
+	}
+
+	/**
+	 * Return the start time of the given process as reported by the kernel,
+	 * or zero when the process does not exist or its start time cannot be
+	 * determined. The value is read from the stat file of the process and
+	 * measured in clock ticks since boot. Together with the process id it
+	 * identifies a single incarnation of a process, since a recycled process
+	 * id will come with a different start time.
+	 */
+	static std::uint64_t process_birth(pid_t pid) noexcept
+	{
+		char path[64];
+		char data[1024];
+		unsigned long long birth = 0;
+
+		std::snprintf(path, sizeof(path), "/proc/%ld/stat", static_cast<long>(pid));
+
+		int descriptor = ::open(path, O_RDONLY);
+		if (descriptor < 0) {
+			return 0;
+		}
+
+		ssize_t done = ::read(descriptor, data, sizeof(data) - 1);
+		::close(descriptor);
+
+		if (done <= 0) {
+			return 0;
+		}
+
+		data[static_cast<std::size_t>(done)] = 0;
+
+		const char* cursor = std::strrchr(data, ')');
+		if (cursor == nullptr) {
+			return 0;
+		} else if (std::sscanf(cursor + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu", &birth) != 1) {
+			return 0;
+		}
+
+		return birth;
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 	//
 	// Backer implementation.
 	//
 	//////////////////////////////////////////////////////////////////////////
 
-	Backer::Backer(const char* path, const Buffer& metadata, const std::vector<std::size_t> components, unsigned int slots, unsigned int mode) :
+	Backer::Backer(const char* path, const Buffer& metadata, const std::vector<std::size_t> components, unsigned int slots, unsigned int mode, std::uint32_t options) :
 		m_path(path),
 		m_file(path, O_RDWR|O_CREAT|O_EXCL, mode),
 		m_slot_count(slots),
@@ -71,9 +133,12 @@ namespace Piper
 		m_header_size(sizeof(Header)),
 		m_metadata_offset(m_page_size),
 		m_metadata_size(metadata.size()),
-		m_total_size(align(m_metadata_offset + m_metadata_size, m_page_size))
+		m_total_size(align(m_metadata_offset + m_metadata_size, m_page_size)),
+		m_options(options)
 	{
-		if (m_slot_count < 2) {
+		if ((m_options & ~(OPTION_PREFAULT|OPTION_LOCK|OPTION_HUGEPAGE|OPTION_STREAM)) != 0) {
+			EXC_START(std::invalid_argument("[Piper::Backer::Backer] Cannot create new backer due to invalid options"));
+		} else if (m_slot_count < 2) {
 			EXC_START(std::invalid_argument("[Piper::Backer::Backer] Cannot create new backer due to invalid slot count"));
 		} else if (m_slot_count > UINT32_MAX) {
 			EXC_START(std::invalid_argument("[Piper::Backer::Backer] Cannot create new backer due to invalid slot count"));
@@ -95,6 +160,14 @@ namespace Piper
 		header.writes = 0;
 		header.tickets = 1;
 		header.session = INVALID_SESSION_ID;
+		header.owner_pid = 0;
+		header.owner_birth = 0;
+		header.options = m_options;
+		header.reserved = 0;
+
+		for (unsigned int i = 0; i < CURSOR_COUNT; i++) {
+			header.cursors[i].position = CURSOR_FREE;
+		}
 
 		for (unsigned int i = 0; i < header.component_count; i++) {
 			std::size_t component_size = components[i];
@@ -140,7 +213,8 @@ namespace Piper
 		m_header_size(sizeof(Header)),
 		m_metadata_offset(m_page_size),
 		m_metadata_size(0),
-		m_total_size(m_page_size)
+		m_total_size(m_page_size),
+		m_options(0)
 	{
 		Header header;
 
@@ -166,11 +240,14 @@ namespace Piper
 			EXC_START(TransportCorruptedException("Piper::Backer::Backer] Cannot open existing backer due to file corruption"));
 		} else if (header.metadata_size == 0) {
 			EXC_START(TransportCorruptedException("Piper::Backer::Backer] Cannot open existing backer due to file corruption"));
+		} else if ((header.options & ~(OPTION_PREFAULT|OPTION_LOCK|OPTION_HUGEPAGE|OPTION_STREAM)) != 0) {
+			EXC_START(TransportCorruptedException("Piper::Backer::Backer] Cannot open existing backer due to file corruption"));
 		}
 
 		m_slot_count = header.slot_count;
 		m_component_count = header.component_count;
 		m_metadata_size = header.metadata_size;
+		m_options = header.options;
 		m_total_size = align(m_metadata_offset + m_metadata_size, m_page_size);
 
 		for (unsigned int i = 0; i < header.component_count; i++) {
@@ -201,6 +278,15 @@ namespace Piper
 		}
 	}
 
+	std::size_t Backer::cursor_offset(unsigned int index) const
+	{
+		if (index >= CURSOR_COUNT) {
+			EXC_START(std::invalid_argument("[Piper::Backer::cursor_offset] Cannot obtain cursor offset due to invalid index"));
+		} else {
+			return offsetof(Header, cursors) + index * sizeof(CursorSlot);
+		}
+	}
+
 	std::size_t Backer::component_size(unsigned int component) const
 	{
 		if (component >= m_component_count) {
@@ -216,10 +302,20 @@ namespace Piper
 	//
 	//////////////////////////////////////////////////////////////////////////
 
+	/**
+	 * Calculate the mmap flags for the given mapping options. Prefaulting
+	 * maps to the MAP_POPULATE flag which instructs the kernel to populate
+	 * the page table of the whole mapping up front.
+	 */
+	static inline int mmap_flags(std::uint32_t options) noexcept
+	{
+		return MAP_SHARED | ((options & Backer::OPTION_PREFAULT) != 0 ? MAP_POPULATE : 0);
+	}
+
 	Medium::Medium(Backer& backer) :
 		m_backer(backer),
 		m_size(m_backer.total_size()),
-		m_pointer(reinterpret_cast<char*>(::mmap(nullptr, m_size, PROT_READ|PROT_WRITE, MAP_SHARED, m_backer.file().descriptor(), 0)))
+		m_pointer(reinterpret_cast<char*>(::mmap(nullptr, m_size, PROT_READ|PROT_WRITE, mmap_flags(m_backer.options()), m_backer.file().descriptor(), 0)))
 	{
 		if (m_pointer == MAP_FAILED) {
 			switch (errno) {
@@ -229,6 +325,38 @@ namespace Piper
 				default: EXC_START(EXC_SYSTEM(errno), TransportIOException("[Piper::Medium::Medium] Cannot map transport medium due to operating system error"));
 			}
 		}
+
+#if defined(MADV_HUGEPAGE)
+		if ((m_backer.options() & Backer::OPTION_HUGEPAGE) != 0) {
+			if (::madvise(m_pointer, m_size, MADV_HUGEPAGE) < 0 && errno != EINVAL) {
+				int error = errno;
+				::munmap(m_pointer, m_size);
+				EXC_START(EXC_SYSTEM(error), TransportIOException("[Piper::Medium::Medium] Cannot apply huge page advice to transport medium due to operating system error"));
+			}
+		}
+#endif
+
+		if ((m_backer.options() & Backer::OPTION_STREAM) != 0) {
+			if (::madvise(m_pointer, m_size, MADV_SEQUENTIAL) < 0 && errno != EINVAL) {
+				int error = errno;
+				::munmap(m_pointer, m_size);
+				EXC_START(EXC_SYSTEM(error), TransportIOException("[Piper::Medium::Medium] Cannot apply sequential advice to transport medium due to operating system error"));
+			}
+		}
+
+		if ((m_backer.options() & Backer::OPTION_LOCK) != 0) {
+			if (::mlock(m_pointer, m_size) < 0) {
+				int error = errno;
+				::munmap(m_pointer, m_size);
+
+				switch (error) {
+					case EAGAIN: EXC_START(EXC_SYSTEM(error), TransportIOException("[Piper::Medium::Medium] Cannot lock transport medium due to operating system limit on locked memory"));
+					case ENOMEM: EXC_START(EXC_SYSTEM(error), TransportIOException("[Piper::Medium::Medium] Cannot lock transport medium due to operating system limit on locked memory"));
+					case EPERM: EXC_START(EXC_SYSTEM(error), TransportIOException("[Piper::Medium::Medium] Cannot lock transport medium due to insufficient privilege"));
+					default: EXC_START(EXC_SYSTEM(error), TransportIOException("[Piper::Medium::Medium] Cannot lock transport medium due to operating system error"));
+				}
+			}
+		}
 	}
 
 	Medium::~Medium()
@@ -272,6 +400,50 @@ namespace Piper
 		return *session;
 	}
 
+	const Medium::OwnerStamp& Medium::owner_pid() const noexcept
+	{
+		OwnerStamp* owner_pid = reinterpret_cast<OwnerStamp*>(m_pointer + m_backer.owner_pid_offset());
+		return *owner_pid;
+	}
+
+	Medium::OwnerStamp& Medium::owner_pid() noexcept
+	{
+		OwnerStamp* owner_pid = reinterpret_cast<OwnerStamp*>(m_pointer + m_backer.owner_pid_offset());
+		return *owner_pid;
+	}
+
+	const Medium::OwnerStamp& Medium::owner_birth() const noexcept
+	{
+		OwnerStamp* owner_birth = reinterpret_cast<OwnerStamp*>(m_pointer + m_backer.owner_birth_offset());
+		return *owner_birth;
+	}
+
+	Medium::OwnerStamp& Medium::owner_birth() noexcept
+	{
+		OwnerStamp* owner_birth = reinterpret_cast<OwnerStamp*>(m_pointer + m_backer.owner_birth_offset());
+		return *owner_birth;
+	}
+
+	const Medium::ReadCursor& Medium::cursor(unsigned int index) const
+	{
+		try {
+			ReadCursor* cursor = reinterpret_cast<ReadCursor*>(m_pointer + m_backer.cursor_offset(index));
+			return *cursor;
+		} catch (std::invalid_argument& ex) {
+			EXC_CHAIN(std::invalid_argument("[Piper::Medium::cursor] Cannot obtain cursor reference due to invalid argument"));
+		}
+	}
+
+	Medium::ReadCursor& Medium::cursor(unsigned int index)
+	{
+		try {
+			ReadCursor* cursor = reinterpret_cast<ReadCursor*>(m_pointer + m_backer.cursor_offset(index));
+			return *cursor;
+		} catch (std::invalid_argument& ex) {
+			EXC_CHAIN(std::invalid_argument("[Piper::Medium::cursor] Cannot obtain cursor reference due to invalid argument"));
+		}
+	}
+
 	const Buffer Medium::metadata() const noexcept
 	{
 		char* start = m_pointer + m_backer.metadata_offset();
@@ -312,6 +484,8 @@ namespace Piper
 		m_writes(medium.writes()),
 		m_tickets(medium.tickets()),
 		m_session(medium.session()),
+		m_owner_pid(medium.owner_pid()),
+		m_owner_birth(medium.owner_birth()),
 		m_capacity(m_medium.backer().slot_count()),
 		m_readable(m_capacity - 1),
 		m_writable(1)
@@ -368,13 +542,34 @@ namespace Piper
 		Session temp = INVALID_SESSION_ID;
 		bool result = m_session.compare_exchange_strong(temp, session, std::memory_order_release);
 
+		if (result == false) {
+			result = takeover(temp, session);
+		}
+
 		if (result) {
+			pid_t pid = ::getpid();
+			m_owner_pid.store(static_cast<std::uint64_t>(pid), std::memory_order_release);
+			m_owner_birth.store(process_birth(pid), std::memory_order_release);
 			return session;
 		} else {
 			EXC_START(TransportConcurrentSessionException("[Piper::Transport::begin] Cannot start new session due to other concurrent session(s)"));
 		}
 	}
 
+	bool Transport::takeover(Session current, Session session)
+	{
+		std::uint64_t pid = m_owner_pid.load(std::memory_order_acquire);
+		std::uint64_t birth = m_owner_birth.load(std::memory_order_acquire);
+
+		if (pid == 0) {
+			return false;
+		} else if (process_birth(static_cast<pid_t>(pid)) == birth) {
+			return false;
+		} else {
+			return m_session.compare_exchange_strong(current, session, std::memory_order_release);
+		}
+	}
+
 	Buffer Transport::input(Session session, Position position, unsigned int component)
 	{
 		if (m_session.load(std::memory_order_acquire) == session) {
@@ -400,19 +595,124 @@ namespace Piper
 	void Transport::flush(Session session)
 	{
 		if (m_session.load(std::memory_order_acquire) == session) {
-			m_writes.fetch_add(Position(1), std::memory_order_release);
+			Position flushed = m_writes.fetch_add(Position(1), std::memory_order_release);
+			::syscall(SYS_futex, futex_word(m_writes), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+
+			if ((m_medium.backer().options() & Backer::OPTION_STREAM) != 0) {
+				stream(flushed);
+			}
 		} else {
 			EXC_START(std::invalid_argument("[Piper::Transport::flush] Cannot flush the transport due to invalid session ID"));
 		}
 	}
 
+	void Transport::stream(Position position)
+	{
+		const Backer& backer(m_medium.backer());
+		const int descriptor = backer.file().descriptor();
+		const unsigned int flushed = static_cast<unsigned int>(position % m_capacity);
+
+		for (unsigned int i = 0; i < backer.component_count(); i++) {
+			const off_t offset = static_cast<off_t>(backer.component_offset(flushed, i));
+			const off_t size = static_cast<off_t>(backer.component_size(i));
+
+			if (::syscall(SYS_sync_file_range, descriptor, offset, size, SYNC_FILE_RANGE_WRITE) < 0 && errno != EINVAL && errno != ESPIPE) {
+				EXC_START(EXC_SYSTEM(errno), TransportIOException("[Piper::Transport::stream] Cannot start writeback of transport block due to operating system error"));
+			}
+		}
+	}
+
+	void Transport::wait(Position position) const
+	{
+		wait(position, -1);
+	}
+
+	void Transport::wait(Position position, int timeout) const
+	{
+		const std::uint32_t* word = futex_word(m_writes);
+		const std::uint32_t expected = static_cast<std::uint32_t>(position);
+
+		struct timespec duration;
+		struct timespec* limit = nullptr;
+
+		if (timeout == 0) {
+			return;
+		} else if (timeout > 0) {
+			duration.tv_sec = timeout / 1000;
+			duration.tv_nsec = (timeout % 1000) * 1000000L;
+			limit = &duration;
+		}
+
+		while (m_writes.load(std::memory_order_acquire) == position) {
+			if (::syscall(SYS_futex, word, FUTEX_WAIT, expected, limit, nullptr, 0) < 0) {
+				switch (errno) {
+					case EAGAIN: continue;
+					case EINTR: return;
+					case ETIMEDOUT: return;
+					case EACCES: EXC_START(std::logic_error("[Piper::Transport::wait] Cannot wait on the transport due to inaccessible futex word"));
+					case EINVAL: EXC_START(std::logic_error("[Piper::Transport::wait] Cannot wait on the transport due to invalid futex word or timeout"));
+					default: EXC_START(EXC_SYSTEM(errno), TransportIOException("[Piper::Transport::wait] Cannot wait on the transport due to operating system error"));
+				}
+			}
+		}
+	}
+
 	void Transport::finish(Session session)
 	{
+		if (m_session.load(std::memory_order_acquire) == session) {
+			m_owner_pid.store(0, std::memory_order_release);
+			m_owner_birth.store(0, std::memory_order_release);
+		}
+
 		if (m_session.compare_exchange_strong(session, INVALID_SESSION_ID, std::memory_order_release) == false) {
 			EXC_START(std::invalid_argument("[Piper::Transport::finish] Cannot finish active session due to invalid session ID"));
 		}
 	}
 
+	unsigned int Transport::claim_cursor()
+	{
+		for (unsigned int i = 0; i < Backer::CURSOR_COUNT; i++) {
+			Position expected = Backer::CURSOR_FREE;
+
+			if (m_medium.cursor(i).compare_exchange_strong(expected, m_writes.load(std::memory_order_acquire), std::memory_order_acq_rel)) {
+				return i;
+			}
+		}
+
+		return CURSOR_NONE;
+	}
+
+	void Transport::update_cursor(unsigned int index, Position position)
+	{
+		if (index == CURSOR_NONE) {
+			return;
+		} else if (index >= Backer::CURSOR_COUNT) {
+			EXC_START(std::invalid_argument("[Piper::Transport::update_cursor] Cannot update read cursor due to invalid index"));
+		} else {
+			m_medium.cursor(index).store(position, std::memory_order_relaxed);
+		}
+	}
+
+	void Transport::release_cursor(unsigned int index)
+	{
+		if (index == CURSOR_NONE) {
+			return;
+		} else if (index >= Backer::CURSOR_COUNT) {
+			EXC_START(std::invalid_argument("[Piper::Transport::release_cursor] Cannot release read cursor due to invalid index"));
+		} else {
+			m_medium.cursor(index).store(Backer::CURSOR_FREE, std::memory_order_release);
+		}
+	}
+
+	Transport::Position Transport::cursor(unsigned int index) const
+	{
+		if (index >= Backer::CURSOR_COUNT) {
+			EXC_START(std::invalid_argument("[Piper::Transport::cursor] Cannot read cursor due to invalid index"));
+		} else {
+			return m_medium.cursor(index).load(std::memory_order_relaxed);
+		}
+	}
+
 	void Transport::set_readable(unsigned int readable)
 	{
 		if (readable < 1) {
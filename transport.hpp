@@ -48,12 +48,67 @@ namespace Piper
 			typedef std::atomic<Position> WriteCounter;
 			typedef std::atomic<Session> TicketCounter;
 			typedef std::atomic<Session> SessionMarker;
+			typedef std::atomic<std::uint64_t> OwnerStamp;
+			typedef std::atomic<Position> ReadCursor;
 
 			/**
-			 * Create a new backer file with the given parameters. The method will
-			 * throw exception when it cannot create the file.
+			 * Cache line size assumed by the header layout. Each hot atomic in
+			 * the header is padded to this size, so that stores to one of them
+			 * never invalidate the cache line holding another.
 			 */
-			explicit Backer(const char* path, const Buffer& metadata, const std::vector<std::size_t> components, unsigned int slots, unsigned int mode);
+			static const unsigned int CACHE_LINE_SIZE = 64;
+
+			/**
+			 * Number of shared read cursor slots in the header.
+			 */
+			static const unsigned int CURSOR_COUNT = 8;
+
+			/**
+			 * Sentinel value stored in unclaimed read cursor slots.
+			 */
+			static const Position CURSOR_FREE = UINT64_MAX;
+
+			/**
+			 * Option flag requesting the medium to prefault the whole mapping
+			 * when the backing file is mapped, so that the first touch of each
+			 * slot does not incur a page fault.
+			 */
+			static const std::uint32_t OPTION_PREFAULT = 0x1;
+
+			/**
+			 * Option flag requesting the medium to lock the whole mapping into
+			 * physical memory when the backing file is mapped, so that the pages
+			 * are populated up front and can never be reclaimed.
+			 */
+			static const std::uint32_t OPTION_LOCK = 0x2;
+
+			/**
+			 * Option flag requesting the medium to advise the kernel to back the
+			 * mapping with transparent huge pages, reducing TLB pressure on
+			 * large transports.
+			 */
+			static const std::uint32_t OPTION_HUGEPAGE = 0x4;
+
+			/**
+			 * Option flag requesting streaming access-pattern advice for pipes
+			 * on persistent storage. The medium advises the kernel that the
+			 * mapping is accessed sequentially, and the transport starts
+			 * asynchronous writeback of each block as it is flushed, so dirty
+			 * pages trickle out continuously instead of stalling the writer
+			 * when accumulated writeback kicks in all at once. The slots stay
+			 * mapped and cached, since every slot of the ring is rewritten
+			 * within a write window worth of flushes. The flag is pointless on
+			 * memory backed file systems like tmpfs.
+			 */
+			static const std::uint32_t OPTION_STREAM = 0x8;
+
+			/**
+			 * Create a new backer file with the given parameters. The options
+			 * are saved in the backing file and honored by every medium mapping
+			 * it afterwards. The method will throw exception when it cannot
+			 * create the file.
+			 */
+			explicit Backer(const char* path, const Buffer& metadata, const std::vector<std::size_t> components, unsigned int slots, unsigned int mode, std::uint32_t options = 0);
 
 			/**
 			 * Open an existing backer file. The method will throw exception when it
@@ -102,6 +157,21 @@ namespace Piper
 			 */
 			std::size_t session_offset() const noexcept { return offsetof(Header, session); }
 
+			/**
+			 * Return the offset to the session owner process id.
+			 */
+			std::size_t owner_pid_offset() const noexcept { return offsetof(Header, owner_pid); }
+
+			/**
+			 * Return the offset to the session owner birth stamp.
+			 */
+			std::size_t owner_birth_offset() const noexcept { return offsetof(Header, owner_birth); }
+
+			/**
+			 * Return the offset to the given read cursor slot.
+			 */
+			std::size_t cursor_offset(unsigned int index) const;
+
 			/**
 			 * Return the offset to the metadata area.
 			 */
@@ -137,6 +207,11 @@ namespace Piper
 			 */
 			std::size_t total_size() const noexcept { return m_total_size; }
 
+			/**
+			 * Return the mapping options of the backing file.
+			 */
+			std::uint32_t options() const noexcept { return m_options; }
+
 			Backer(const Backer& backer) = delete;
 			Backer(Backer&& backer) = delete;
 			Backer& operator=(const Backer& backer) = delete;
@@ -147,7 +222,7 @@ namespace Piper
 			/**
 			 * Transport version.
 			 */
-			static const std::uint32_t VERSION = 1;
+			static const std::uint32_t VERSION = 2;
 
 			/**
 			 * Component limit represents the maximum number of components a
@@ -182,7 +257,35 @@ namespace Piper
 			 * `session` is an atomic variable tracking the current update session.
 			 * Only the session starter is allowed to update the transport. If there
 			 * is no active session, a special sentinel value is stored.
+			 *
+			 * `owner_pid` and `owner_birth` identify the process holding the
+			 * current update session. They store the process id of the session
+			 * holder and the start time of that process as reported by the
+			 * kernel, and hold zero when the identity is unknown. New session
+			 * starters consult the pair to detect sessions left behind by dead
+			 * processes and reclaim them in place. Both fields share the cache
+			 * line of the session marker, as they are only touched when a
+			 * session starts or ends.
+			 *
+			 * `options` stores the mapping options of the transport as a bitmask
+			 * of the option flags. `reserved` pads the header and should be zero.
+			 *
+			 * The hot atomics live at the end of the header and each of them is
+			 * padded to its own cache line, so that write counter updates by the
+			 * writer never invalidate the cache lines readers poll for session
+			 * and cursor state.
+			 *
+			 * `cursors` is an array of shared read cursor slots. A reader can
+			 * claim a free slot and publish its read position there, so that
+			 * the writer and diagnostic tools can observe reader lag. Unclaimed
+			 * slots hold the cursor free sentinel. Each slot sits on its own
+			 * cache line so readers do not disturb each other either.
 			 */
+			struct alignas(CACHE_LINE_SIZE) CursorSlot
+			{
+				ReadCursor position;
+			};
+
 			struct Header
 			{
 				std::uint32_t version = VERSION;
@@ -191,24 +294,36 @@ namespace Piper
 				std::uint32_t page_size;
 				std::uint32_t metadata_size;
 				std::uint32_t component_sizes[MAX_COMPONENT_COUNT];
-				WriteCounter writes;
-				TicketCounter tickets;
-				SessionMarker session;
+				std::uint32_t options;
+				std::uint32_t reserved;
+				alignas(CACHE_LINE_SIZE) WriteCounter writes;
+				alignas(CACHE_LINE_SIZE) TicketCounter tickets;
+				alignas(CACHE_LINE_SIZE) SessionMarker session;
+				OwnerStamp owner_pid;
+				OwnerStamp owner_birth;
+				alignas(CACHE_LINE_SIZE) CursorSlot cursors[CURSOR_COUNT];
 			};
 
 			static_assert(sizeof(WriteCounter) == sizeof(Position), "incorrect layout for transport header");
 			static_assert(sizeof(TicketCounter) == sizeof(Session), "incorrect layout for transport header");
 			static_assert(sizeof(SessionMarker) == sizeof(Session), "incorrect layout for transport header");
+			static_assert(sizeof(CursorSlot) == CACHE_LINE_SIZE, "incorrect layout for transport header");
 
 			static_assert(offsetof(Header, slot_count) - offsetof(Header, version) == sizeof(Header::version), "incorrect layout for transport header");
 			static_assert(offsetof(Header, component_count) - offsetof(Header, slot_count) == sizeof(Header::slot_count), "incorrect layout for transport header");
 			static_assert(offsetof(Header, page_size) - offsetof(Header, component_count) == sizeof(Header::component_count), "incorrect layout for transport header");
 			static_assert(offsetof(Header, metadata_size) - offsetof(Header, page_size) == sizeof(Header::page_size), "incorrect layout for transport header");
 			static_assert(offsetof(Header, component_sizes) - offsetof(Header, metadata_size) == sizeof(Header::metadata_size), "incorrect layout for transport header");
-			static_assert(offsetof(Header, writes) - offsetof(Header, component_sizes) == sizeof(Header::component_sizes), "incorrect layout for transport header");
-			static_assert(offsetof(Header, tickets) - offsetof(Header, writes) == sizeof(Header::tickets), "incorrect layout for transport header");
-			static_assert(offsetof(Header, session) - offsetof(Header, tickets) == sizeof(Header::session), "incorrect layout for transport header");
-			static_assert(sizeof(Header) - offsetof(Header, session) == sizeof(Header::session), "incorrect layout for transport header");
+			static_assert(offsetof(Header, options) - offsetof(Header, component_sizes) == sizeof(Header::component_sizes), "incorrect layout for transport header");
+			static_assert(offsetof(Header, reserved) - offsetof(Header, options) == sizeof(Header::options), "incorrect layout for transport header");
+			static_assert(offsetof(Header, writes) % CACHE_LINE_SIZE == 0, "incorrect layout for transport header");
+			static_assert(offsetof(Header, tickets) - offsetof(Header, writes) == CACHE_LINE_SIZE, "incorrect layout for transport header");
+			static_assert(offsetof(Header, session) - offsetof(Header, tickets) == CACHE_LINE_SIZE, "incorrect layout for transport header");
+			static_assert(offsetof(Header, owner_pid) - offsetof(Header, session) == sizeof(SessionMarker), "incorrect layout for transport header");
+			static_assert(offsetof(Header, owner_birth) - offsetof(Header, owner_pid) == sizeof(OwnerStamp), "incorrect layout for transport header");
+			static_assert(offsetof(Header, cursors) - offsetof(Header, session) == CACHE_LINE_SIZE, "incorrect layout for transport header");
+			static_assert(sizeof(Header) - offsetof(Header, cursors) == CURSOR_COUNT * CACHE_LINE_SIZE, "incorrect layout for transport header");
+			static_assert(sizeof(Header) <= 4096, "incorrect layout for transport header");
 
 			static_assert(sizeof(unsigned int) >= sizeof(std::uint32_t), "possible precision loss");
 			static_assert(sizeof(std::size_t) >= sizeof(std::uint32_t), "possible precision loss");
@@ -225,12 +340,15 @@ namespace Piper
 			std::size_t m_component_offsets[MAX_COMPONENT_COUNT];
 			std::size_t m_component_sizes[MAX_COMPONENT_COUNT];
 			std::size_t m_total_size;
+			std::uint32_t m_options;
 
 	};
 
 	/**
 	 * Medium represents shared memory created from the backing file
-	 * for interprocess communication.
+	 * for interprocess communication. The mapping honors the options
+	 * saved in the backing file, covering prefaulting, memory locking,
+	 * transparent huge page backing and streaming access-pattern advice.
 	 */
 	class Medium
 	{
@@ -241,6 +359,8 @@ namespace Piper
 			typedef Backer::WriteCounter WriteCounter;
 			typedef Backer::TicketCounter TicketCounter;
 			typedef Backer::SessionMarker SessionMarker;
+			typedef Backer::OwnerStamp OwnerStamp;
+			typedef Backer::ReadCursor ReadCursor;
 
 			/**
 			 * Create a medium from the backing file.
@@ -287,6 +407,36 @@ namespace Piper
 			 */
 			SessionMarker& session() noexcept;
 
+			/**
+			 * Return the reference to the session owner process id.
+			 */
+			const OwnerStamp& owner_pid() const noexcept;
+
+			/**
+			 * Return the reference to the session owner process id.
+			 */
+			OwnerStamp& owner_pid() noexcept;
+
+			/**
+			 * Return the reference to the session owner birth stamp.
+			 */
+			const OwnerStamp& owner_birth() const noexcept;
+
+			/**
+			 * Return the reference to the session owner birth stamp.
+			 */
+			OwnerStamp& owner_birth() noexcept;
+
+			/**
+			 * Return the reference to the given read cursor slot.
+			 */
+			const ReadCursor& cursor(unsigned int index) const;
+
+			/**
+			 * Return the reference to the given read cursor slot.
+			 */
+			ReadCursor& cursor(unsigned int index);
+
 			/**
 			 * Return the buffer to the metadata region.
 			 */
@@ -378,6 +528,14 @@ namespace Piper
 			typedef Medium::Position Position;
 			typedef Medium::Session Session;
 
+			/**
+			 * Index value returned by the claim cursor method when every read
+			 * cursor slot is already claimed. Passing the value to the update
+			 * and release methods is a no-op, so readers without a slot can
+			 * use the cursor interface unconditionally.
+			 */
+			static const unsigned int CURSOR_NONE = UINT32_MAX;
+
 			/**
 			 * Create a transport from the medium.
 			 */
@@ -437,7 +595,10 @@ namespace Piper
 			/**
 			 * Start an update session and returns the session id. The method will
 			 * throws a concurrent session exception when another update session
-			 * is under way.
+			 * is under way. However, when the process holding the existing
+			 * session no longer exists, the session is deemed stale and is
+			 * taken over in place, so a restarted writer can resume writing
+			 * without running a separate unclog pass over the transport first.
 			 */
 			Session begin();
 
@@ -452,12 +613,36 @@ namespace Piper
 			/**
 			 * Flush the first writable block. The block will be converted into a
 			 * readable block, and a new writable block will be appended to the end
-			 * of the transport. The method requires an active update session id and
-			 * throws an invalid argument exception when an incorrect session id is
-			 * provided.
+			 * of the transport. The method will also wake up all clients waiting
+			 * on the transport via the wait method. The method requires an active
+			 * update session id and throws an invalid argument exception when an
+			 * incorrect session id is provided.
 			 */
 	    void flush(Session sid);
 
+			/**
+			 * Wait for the write counter to advance past the given position. The
+			 * method will return when the write counter no longer matches the
+			 * given position, or when the calling process receives incoming
+			 * signal.
+			 *
+			 * This call is equivalent to calling the `wait(Position, int)` method
+			 * with timeout -1.
+			 */
+			void wait(Position position) const;
+
+			/**
+			 * Wait for the write counter to advance past the given position. The
+			 * method will return when the write counter no longer matches the
+			 * given position, or when the calling process receives incoming
+			 * signal, or when the specified timeout has elapsed.
+			 *
+			 * Note that the timeout is measured in milliseconds and accepts 2
+			 * special values. The timeout of 0 means no waiting. The timeout of
+			 * -1 indicates that timeout is not observed.
+			 */
+			void wait(Position position, int timeout) const;
+
 			/**
 			 * Finish the active update session. The method requires an active update
 			 * session id, and throws an invalid argument exception when an incorrect
@@ -465,6 +650,41 @@ namespace Piper
 			 */
 	    void finish(Session sid);
 
+			/**
+			 * Return the number of read cursor slots in the transport.
+			 */
+			unsigned int cursor_count() const noexcept { return Backer::CURSOR_COUNT; }
+
+			/**
+			 * Claim a free read cursor slot and return its index. The slot is
+			 * initialized to the current write position. When every slot is
+			 * already claimed, the method returns the cursor none sentinel and
+			 * the reader proceeds without a shared cursor.
+			 */
+			unsigned int claim_cursor();
+
+			/**
+			 * Publish the given read position to the given read cursor slot.
+			 * The method is a no-op when the cursor none sentinel is passed,
+			 * and throws an invalid argument exception for other out-of-range
+			 * indices.
+			 */
+			void update_cursor(unsigned int index, Position position);
+
+			/**
+			 * Release the given read cursor slot so other readers can claim
+			 * it. The method is a no-op when the cursor none sentinel is
+			 * passed, and throws an invalid argument exception for other
+			 * out-of-range indices.
+			 */
+			void release_cursor(unsigned int index);
+
+			/**
+			 * Return the position stored in the given read cursor slot. The
+			 * method returns the cursor free sentinel for unclaimed slots.
+			 */
+			Position cursor(unsigned int index) const;
+
 			/**
 			 * Adjust the read window. The write window will be adjusted when
 			 * necessary.
@@ -484,10 +704,35 @@ namespace Piper
 
 		private:
 
+			/**
+			 * Attempt to take over a stale update session. The method checks
+			 * whether the process identified by the owner stamps still exists,
+			 * and when it does not, swings the session marker from the given
+			 * current session to the given new session with a single compare
+			 * and exchange. The method returns true when the takeover succeeds
+			 * and false when the existing session is live, anonymous or
+			 * concurrently reclaimed.
+			 */
+			bool takeover(Session current, Session session);
+
+			/**
+			 * Apply streaming access-pattern advice after a flush of the given
+			 * position. The method starts asynchronous writeback of the block
+			 * that just became readable, so its dirty pages are cleaned close
+			 * to the time they are written instead of piling up for a bulk
+			 * writeback stall. The block itself stays mapped and cached, since
+			 * the ring rewrites it again within a write window worth of
+			 * flushes. The method is called from the flush method only when
+			 * the stream option is saved in the backing file.
+			 */
+			void stream(Position position);
+
 			Medium& m_medium;
 			Medium::WriteCounter& m_writes;
 			Medium::TicketCounter& m_tickets;
 			Medium::SessionMarker& m_session;
+			Medium::OwnerStamp& m_owner_pid;
+			Medium::OwnerStamp& m_owner_birth;
 			unsigned int m_capacity;
 			unsigned int m_readable;
 			unsigned int m_writable;
@@ -0,0 +1,319 @@
+
+
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE
+#define _BSD_SOURCE
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <system_error>
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#include <linux/io_uring.h>
+#endif
+
+#include "exception.hpp"
+#include "buffer.hpp"
+#include "file.hpp"
+#include "uring.hpp"
+
+
+#define EXC_START(...) Support::Exception::start(__VA_ARGS__, "uring.cpp", __LINE__)
+#define EXC_CHAIN(...) Support::Exception::chain(__VA_ARGS__, "uring.cpp", __LINE__);
+#define EXC_SYSTEM(err) std::system_error(err, std::system_category(), strerror(err))
+
+
+namespace Piper
+{
+
+	//////////////////////////////////////////////////////////////////////////
+	//
+	// Ring implementation.
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+
+	Ring::Ring(unsigned int depth) :
+		m_descriptor(-1),
+		m_depth(depth),
+		m_sq_area(nullptr),
+		m_sq_size(0),
+		m_sqe_area(nullptr),
+		m_sqe_size(0),
+		m_cq_area(nullptr),
+		m_cq_size(0),
+		m_sq_head(nullptr),
+		m_sq_tail(nullptr),
+		m_sq_mask(0),
+		m_sq_array(nullptr),
+		m_sqes(nullptr),
+		m_cq_head(nullptr),
+		m_cq_tail(nullptr),
+		m_cq_mask(0),
+		m_cqes(nullptr)
+	{
+		struct io_uring_params params;
+		std::memset(&params, 0, sizeof(params));
+
+		if (m_depth == 0 || m_depth > 4096) {
+			EXC_START(std::invalid_argument("[Piper::Ring::Ring] Cannot create ring due to invalid depth"));
+		}
+
+		long result = ::syscall(__NR_io_uring_setup, m_depth, &params);
+
+		if (result < 0) {
+			switch (errno) {
+				case ENOSYS: EXC_START(RingUnsupportedException("[Piper::Ring::Ring] Cannot create ring due to missing io_uring support in the kernel"));
+				case EPERM: EXC_START(RingUnsupportedException("[Piper::Ring::Ring] Cannot create ring due to disabled io_uring support in the kernel"));
+				case EINVAL: EXC_START(std::invalid_argument("[Piper::Ring::Ring] Cannot create ring due to invalid parameters"));
+				default: EXC_START(EXC_SYSTEM(errno), RingException("[Piper::Ring::Ring] Cannot create ring due to operating system error"));
+			}
+		}
+
+		m_descriptor = static_cast<int>(result);
+
+		// Probe the opcodes used by the ring before mapping the queues. A
+		// successful setup alone does not imply that the read and write
+		// opcodes are available, since they entered the kernel later than
+		// the ring itself, and without the probe every operation on such a
+		// kernel would fail with EINVAL afterwards instead of letting the
+		// caller fall back to the classic path.
+
+		char storage[sizeof(struct io_uring_probe) + IORING_OP_LAST * sizeof(struct io_uring_probe_op)];
+		struct io_uring_probe* probe = reinterpret_cast<struct io_uring_probe*>(storage);
+
+		std::memset(storage, 0, sizeof(storage));
+
+		if (::syscall(__NR_io_uring_register, m_descriptor, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) < 0) {
+			int error = errno;
+
+			::close(m_descriptor);
+			m_descriptor = -1;
+
+			switch (error) {
+				case EINVAL: EXC_START(RingUnsupportedException("[Piper::Ring::Ring] Cannot create ring due to missing opcode probe support in the kernel"));
+				default: EXC_START(EXC_SYSTEM(error), RingException("[Piper::Ring::Ring] Cannot probe ring opcodes due to operating system error"));
+			}
+		} else if ((probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) == 0 || (probe->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED) == 0) {
+			::close(m_descriptor);
+			m_descriptor = -1;
+
+			EXC_START(RingUnsupportedException("[Piper::Ring::Ring] Cannot create ring due to missing read and write opcodes in the kernel"));
+		}
+
+		m_sq_size = params.sq_off.array + params.sq_entries * sizeof(std::uint32_t);
+		m_sqe_size = params.sq_entries * sizeof(struct io_uring_sqe);
+		m_cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+		void* sq_area = ::mmap(nullptr, m_sq_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, m_descriptor, IORING_OFF_SQ_RING);
+		void* sqe_area = ::mmap(nullptr, m_sqe_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, m_descriptor, IORING_OFF_SQES);
+		void* cq_area = ::mmap(nullptr, m_cq_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, m_descriptor, IORING_OFF_CQ_RING);
+
+		if (sq_area == MAP_FAILED || sqe_area == MAP_FAILED || cq_area == MAP_FAILED) {
+			int error = errno;
+
+			if (sq_area != MAP_FAILED) {
+				::munmap(sq_area, m_sq_size);
+			}
+
+			if (sqe_area != MAP_FAILED) {
+				::munmap(sqe_area, m_sqe_size);
+			}
+
+			if (cq_area != MAP_FAILED) {
+				::munmap(cq_area, m_cq_size);
+			}
+
+			::close(m_descriptor);
+			m_descriptor = -1;
+
+			EXC_START(EXC_SYSTEM(error), RingException("[Piper::Ring::Ring] Cannot map ring queues due to operating system error"));
+		}
+
+		m_sq_area = reinterpret_cast<char*>(sq_area);
+		m_sqe_area = reinterpret_cast<char*>(sqe_area);
+		m_cq_area = reinterpret_cast<char*>(cq_area);
+
+		m_sq_head = reinterpret_cast<std::atomic<std::uint32_t>*>(m_sq_area + params.sq_off.head);
+		m_sq_tail = reinterpret_cast<std::atomic<std::uint32_t>*>(m_sq_area + params.sq_off.tail);
+		m_sq_mask = *reinterpret_cast<std::uint32_t*>(m_sq_area + params.sq_off.ring_mask);
+		m_sq_array = reinterpret_cast<std::uint32_t*>(m_sq_area + params.sq_off.array);
+		m_sqes = reinterpret_cast<struct io_uring_sqe*>(m_sqe_area);
+
+		m_cq_head = reinterpret_cast<std::atomic<std::uint32_t>*>(m_cq_area + params.cq_off.head);
+		m_cq_tail = reinterpret_cast<std::atomic<std::uint32_t>*>(m_cq_area + params.cq_off.tail);
+		m_cq_mask = *reinterpret_cast<std::uint32_t*>(m_cq_area + params.cq_off.ring_mask);
+		m_cqes = reinterpret_cast<struct io_uring_cqe*>(m_cq_area + params.cq_off.cqes);
+	}
+
+	Ring::~Ring()
+	{
+		if (m_sq_area != nullptr) {
+			::munmap(m_sq_area, m_sq_size);
+		}
+
+		if (m_sqe_area != nullptr) {
+			::munmap(m_sqe_area, m_sqe_size);
+		}
+
+		if (m_cq_area != nullptr) {
+			::munmap(m_cq_area, m_cq_size);
+		}
+
+		if (m_descriptor >= 0) {
+			::close(m_descriptor);
+		}
+	}
+
+	void Ring::prepare(std::uint8_t opcode, int descriptor, const char* address, std::size_t size)
+	{
+		std::uint32_t tail = m_sq_tail->load(std::memory_order_acquire);
+		std::uint32_t index = tail & m_sq_mask;
+		struct io_uring_sqe& sqe(m_sqes[index]);
+
+		std::memset(&sqe, 0, sizeof(sqe));
+		sqe.opcode = opcode;
+		sqe.fd = descriptor;
+		sqe.off = static_cast<std::uint64_t>(-1);
+		sqe.addr = reinterpret_cast<std::uint64_t>(address);
+		sqe.len = static_cast<std::uint32_t>(size <= UINT32_MAX ? size : UINT32_MAX);
+
+		m_sq_array[index] = index;
+		m_sq_tail->store(tail + 1, std::memory_order_release);
+	}
+
+	int Ring::submit()
+	{
+		while (true) {
+			std::uint32_t head = m_cq_head->load(std::memory_order_acquire);
+
+			if (head != m_cq_tail->load(std::memory_order_acquire)) {
+				const struct io_uring_cqe& cqe(m_cqes[head & m_cq_mask]);
+				int result = cqe.res;
+				m_cq_head->store(head + 1, std::memory_order_release);
+				return result;
+			}
+
+			// The kernel advances the submission queue head when it consumes
+			// entries, so any distance between the head and the tail indicates
+			// entries the kernel has not picked up yet, for example when the
+			// previous submission attempt was cut short by a signal.
+
+			std::uint32_t pending = m_sq_tail->load(std::memory_order_relaxed) - m_sq_head->load(std::memory_order_acquire);
+			long done = ::syscall(__NR_io_uring_enter, m_descriptor, pending, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+
+			if (done < 0 && errno != EINTR) {
+				switch (errno) {
+					case EBADF: EXC_START(std::logic_error("[Piper::Ring::submit] Cannot submit operation to ring due to stale descriptor"));
+					case EINVAL: EXC_START(std::logic_error("[Piper::Ring::submit] Cannot submit operation to ring due to invalid parameters"));
+					default: EXC_START(EXC_SYSTEM(errno), RingException("[Piper::Ring::submit] Cannot submit operation to ring due to operating system error"));
+				}
+			}
+		}
+	}
+
+	void Ring::read(int descriptor, Destination& destination)
+	{
+		Buffer data(destination.data());
+
+		prepare(IORING_OP_READ, descriptor, data.start(), data.size());
+		int result = submit();
+
+		if (result > 0) {
+			destination.consume(static_cast<std::size_t>(result));
+		} else if (result == 0) {
+			EXC_START(EndOfFileException("[Piper::Ring::read] Cannot read past the end of file"));
+		} else if (result == -EINTR || result == -EAGAIN || result == -EWOULDBLOCK) {
+			return;
+		} else if (result == -EBADF) {
+			EXC_START(std::logic_error("[Piper::Ring::read] Cannot read file due to stale descriptor"));
+		} else {
+			EXC_START(EXC_SYSTEM(-result), FileIOException("[Piper::Ring::read] Cannot read file due to operating system error"));
+		}
+	}
+
+	void Ring::write(int descriptor, Source& source)
+	{
+		const Buffer data(source.data());
+
+		prepare(IORING_OP_WRITE, descriptor, data.start(), data.size());
+		int result = submit();
+
+		if (result >= 0) {
+			source.consume(static_cast<std::size_t>(result));
+		} else if (result == -EINTR || result == -EAGAIN || result == -EWOULDBLOCK) {
+			return;
+		} else if (result == -EPIPE) {
+			EXC_START(EndOfFileException("[Piper::Ring::write] Cannot write file due to closed receiver side"));
+		} else if (result == -EBADF) {
+			EXC_START(std::logic_error("[Piper::Ring::write] Cannot write file due to stale descriptor"));
+		} else {
+			EXC_START(EXC_SYSTEM(-result), FileIOException("[Piper::Ring::write] Cannot write file due to operating system error"));
+		}
+	}
+
+#else
+
+	Ring::Ring(unsigned int depth) :
+		m_descriptor(-1),
+		m_depth(depth),
+		m_sq_area(nullptr),
+		m_sq_size(0),
+		m_sqe_area(nullptr),
+		m_sqe_size(0),
+		m_cq_area(nullptr),
+		m_cq_size(0),
+		m_sq_head(nullptr),
+		m_sq_tail(nullptr),
+		m_sq_mask(0),
+		m_sq_array(nullptr),
+		m_sqes(nullptr),
+		m_cq_head(nullptr),
+		m_cq_tail(nullptr),
+		m_cq_mask(0),
+		m_cqes(nullptr)
+	{
+		EXC_START(RingUnsupportedException("[Piper::Ring::Ring] Cannot create ring due to missing io_uring support in the build"));
+	}
+
+	Ring::~Ring()
+	{
+		// do nothing
+	}
+
+	void Ring::prepare([[ gnu::unused ]] std::uint8_t opcode, [[ gnu::unused ]] int descriptor, [[ gnu::unused ]] const char* address, [[ gnu::unused ]] std::size_t size)
+	{
+		// do nothing
+	}
+
+	int Ring::submit()
+	{
+		return -ENOSYS;
+	}
+
+	void Ring::read([[ gnu::unused ]] int descriptor, [[ gnu::unused ]] Destination& destination)
+	{
+		// do nothing
+	}
+
+	void Ring::write([[ gnu::unused ]] int descriptor, [[ gnu::unused ]] Source& source)
+	{
+		// do nothing
+	}
+
+#endif
+
+}
+
+
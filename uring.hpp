@@ -0,0 +1,177 @@
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+
+#include "buffer.hpp"
+#include "file.hpp"
+
+
+#ifndef URING_HPP_
+#define URING_HPP_
+
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+
+namespace Piper
+{
+
+	/**
+	 * Ring is a RAII wrapper class that manages an io_uring instance. The
+	 * class submits read and write operations to the kernel through the
+	 * shared submission queue and reaps their results from the shared
+	 * completion queue, so a transfer costs at most a single syscall
+	 * instead of the separate poll and read/write calls of the classic
+	 * file I/O path.
+	 *
+	 * The class supports kernels without io_uring by throwing ring
+	 * unsupported exception from the constructor, allowing callers to
+	 * fall back to the classic path. The constructor also probes the ring
+	 * for the read and write opcodes, so kernels that accept the ring
+	 * setup but predate the opcodes are reported the same way instead of
+	 * failing every operation afterwards.
+	 */
+	class Ring
+	{
+		public:
+
+			/**
+			 * Create a new ring with the given submission queue depth. Throws
+			 * ring unsupported exception when the kernel does not support
+			 * io_uring or lacks the opcodes used by the ring, and other
+			 * exceptions when the ring cannot be created.
+			 */
+			explicit Ring(unsigned int depth);
+
+			/**
+			 * Destruct the ring by unmapping the queues and closing the ring
+			 * descriptor.
+			 */
+			~Ring();
+
+			/**
+			 * Return the submission queue depth of the ring.
+			 */
+			unsigned int depth() const noexcept { return m_depth; }
+
+			/**
+			 * Read data from the given descriptor into the destination. The
+			 * method will submit a single read operation to the ring, wait for
+			 * its completion and update the destination counter accordingly.
+			 * Operations cut short by signals may complete without transferring
+			 * anything, in which case the method returns without progress.
+			 */
+			void read(int descriptor, Destination& destination);
+
+			/**
+			 * Write data from the source to the given descriptor. The method
+			 * will submit a single write operation to the ring, wait for its
+			 * completion and update the source counter accordingly. Operations
+			 * cut short by signals may complete without transferring anything,
+			 * in which case the method returns without progress.
+			 */
+			void write(int descriptor, Source& source);
+
+			Ring(const Ring& ring) = delete;
+			Ring(Ring&& ring) = delete;
+			Ring& operator=(const Ring& ring) = delete;
+			Ring& operator=(Ring&& ring) = delete;
+
+		private:
+
+			/**
+			 * Append an operation with the given opcode, descriptor and data
+			 * run to the submission queue.
+			 */
+			void prepare(std::uint8_t opcode, int descriptor, const char* address, std::size_t size);
+
+			/**
+			 * Submit the pending operation to the kernel, wait for its
+			 * completion and return the completion result. The result follows
+			 * the kernel convention of byte count on success and negated errno
+			 * on failure.
+			 */
+			int submit();
+
+			/**
+			 * Descriptor of the ring.
+			 */
+			int m_descriptor;
+
+			/**
+			 * Submission queue depth of the ring.
+			 */
+			unsigned int m_depth;
+
+			/**
+			 * Mapped area of the submission queue ring and its size.
+			 */
+			char* m_sq_area;
+			std::size_t m_sq_size;
+
+			/**
+			 * Mapped area of the submission queue entries and its size.
+			 */
+			char* m_sqe_area;
+			std::size_t m_sqe_size;
+
+			/**
+			 * Mapped area of the completion queue ring and its size.
+			 */
+			char* m_cq_area;
+			std::size_t m_cq_size;
+
+			/**
+			 * Pointers into the submission queue ring. The head is updated by
+			 * the kernel when it consumes entries and the tail is updated by
+			 * this class when it appends entries.
+			 */
+			std::atomic<std::uint32_t>* m_sq_head;
+			std::atomic<std::uint32_t>* m_sq_tail;
+			std::uint32_t m_sq_mask;
+			std::uint32_t* m_sq_array;
+			struct io_uring_sqe* m_sqes;
+
+			/**
+			 * Pointers into the completion queue ring. The head is updated by
+			 * this class when it reaps entries and the tail is updated by the
+			 * kernel when it posts entries.
+			 */
+			std::atomic<std::uint32_t>* m_cq_head;
+			std::atomic<std::uint32_t>* m_cq_tail;
+			std::uint32_t m_cq_mask;
+			struct io_uring_cqe* m_cqes;
+
+	};
+
+	/**
+	 * Exception thrown when ring operation fails.
+	 */
+	class RingException : public std::runtime_error
+	{
+		public:
+			using std::runtime_error::runtime_error;
+	};
+
+	/**
+	 * Exception thrown when the kernel does not support io_uring. Callers
+	 * should catch the exception and fall back to the classic file I/O
+	 * path.
+	 */
+	class RingUnsupportedException : public RingException
+	{
+		public:
+			using RingException::RingException;
+	};
+
+}
+
+
+#endif
+
+